@@ -28,6 +28,8 @@
 /* Authors:  Zack Rusin <zackr@vmware.com>
  */
 
+#include <stdlib.h>
+
 #include "util/u_debug.h"
 
 #include "util/u_memory.h"
@@ -66,6 +68,45 @@ cso_delete_state(struct pipe_context *pipe, void *state,
 }
 
 
+static int
+compare_last_use(const void *a, const void *b)
+{
+   uint64_t ua = *(const uint64_t *)a;
+   uint64_t ub = *(const uint64_t *)b;
+
+   return ua < ub ? -1 : ua > ub;
+}
+
+
+/**
+ * Return the last use of the most recently used entry among the \p count
+ * least recently used entries of the hash. Evicting entries that weren't
+ * used after that evicts the least recently used entries first.
+ */
+uint64_t
+cso_cache_lru_threshold(struct cso_hash *hash, int count)
+{
+   int size = cso_hash_size(hash);
+
+   if (count >= size)
+      return UINT64_MAX;
+
+   uint64_t *last_use = MALLOC(size * sizeof(*last_use));
+   if (!last_use)
+      return UINT64_MAX;
+
+   int n = 0;
+   for (struct cso_hash_iter iter = cso_hash_first_node(hash);
+        !cso_hash_iter_is_null(iter); iter = cso_hash_iter_next(iter))
+      last_use[n++] = iter.node->last_use;
+
+   qsort(last_use, n, sizeof(*last_use), compare_last_use);
+   uint64_t threshold = last_use[count - 1];
+   FREE(last_use);
+   return threshold;
+}
+
+
 static inline void
 sanitize_hash(struct cso_cache *sc,
               struct cso_hash *hash,
@@ -90,13 +131,22 @@ sanitize_cb(struct cso_hash *hash, enum cso_cache_type type,
    int to_remove =  (max_size < max_entries) * max_entries/4;
    if (hash_size > max_size)
       to_remove += hash_size - max_size;
-   while (to_remove) {
-      /*remove elements until we're good */
-      /*fixme: currently we pick the nodes to remove at random*/
-      struct cso_hash_iter iter = cso_hash_first_node(hash);
-      void  *cso = cso_hash_take(hash, cso_hash_iter_key(iter));
-      cache->delete_cso(cache->delete_cso_ctx, cso, type);
-      --to_remove;
+   if (to_remove == 0)
+      return;
+
+   /* Remove the least recently used entries. */
+   uint64_t threshold = cso_cache_lru_threshold(hash, to_remove);
+   struct cso_hash_iter iter = cso_hash_first_node(hash);
+   while (to_remove && !cso_hash_iter_is_null(iter)) {
+      if (iter.node->last_use <= threshold) {
+         cache->delete_cso(cache->delete_cso_ctx, cso_hash_iter_data(iter),
+                           type);
+         iter = cso_hash_erase(hash, iter);
+         cache->stats[type].evictions++;
+         --to_remove;
+      } else {
+         iter = cso_hash_iter_next(iter);
+      }
    }
 }
 
@@ -108,7 +158,11 @@ cso_insert_state(struct cso_cache *sc,
 {
    struct cso_hash *hash = &sc->hashes[type];
    sanitize_hash(sc, hash, type, sc->max_size);
-   return cso_hash_insert(hash, hash_key, state);
+
+   struct cso_hash_iter iter = cso_hash_insert(hash, hash_key, state);
+   if (!cso_hash_iter_is_null(iter))
+      iter.node->last_use = ++sc->lru_clock;
+   return iter;
 }
 
 
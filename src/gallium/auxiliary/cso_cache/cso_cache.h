@@ -104,10 +104,23 @@ typedef void (*cso_sanitize_callback)(struct cso_hash *hash,
                                       int max_size,
                                       void *user_data);
 
+struct cso_cache_stats {
+   unsigned hits;
+   unsigned misses;
+   unsigned evictions;
+};
+
 struct cso_cache {
    struct cso_hash hashes[CSO_CACHE_MAX];
    int max_size;
 
+   /* Incremented on every lookup hit and insertion, and stored in the hash
+    * node of the entry, so that the least recently used entries can be
+    * evicted first.
+    */
+   uint64_t lru_clock;
+   struct cso_cache_stats stats[CSO_CACHE_MAX];
+
    cso_sanitize_callback sanitize_cb;
    void *sanitize_data;
 
@@ -174,6 +187,9 @@ void
 cso_delete_state(struct pipe_context *pipe, void *state,
                  enum cso_cache_type type);
 
+uint64_t
+cso_cache_lru_threshold(struct cso_hash *hash, int count);
+
 
 static ALWAYS_INLINE unsigned
 cso_construct_key(const void *key, int key_size)
@@ -200,10 +216,14 @@ cso_find_state_template(struct cso_cache *sc, unsigned hash_key,
 
    while (!cso_hash_iter_is_null(iter)) {
       void *iter_data = cso_hash_iter_data(iter);
-      if (!memcmp(iter_data, key, key_size))
+      if (!memcmp(iter_data, key, key_size)) {
+         iter.node->last_use = ++sc->lru_clock;
+         sc->stats[type].hits++;
          return iter;
+      }
       iter = cso_hash_iter_next(iter);
    }
+   sc->stats[type].misses++;
    return iter;
 }
 
@@ -210,20 +210,27 @@ sanitize_hash(struct cso_hash *hash, enum cso_cache_type type,
       }
    }
 
-   struct cso_hash_iter iter = cso_hash_first_node(hash);
-   while (to_remove) {
-      /*remove elements until we're good */
-      /*fixme: currently we pick the nodes to remove at random*/
-      void *cso = cso_hash_iter_data(iter);
-
-      if (!cso)
-         break;
-
-      if (delete_cso(ctx, cso, type)) {
-         iter = cso_hash_erase(hash, iter);
-         --to_remove;
-      } else {
-         iter = cso_hash_iter_next(iter);
+   /* Remove the least recently used entries. Bound states are skipped, so
+    * fall back to any other entries if that's not enough.
+    */
+   uint64_t threshold = cso_cache_lru_threshold(hash, to_remove);
+   for (unsigned pass = 0; pass < 2 && to_remove; pass++) {
+      struct cso_hash_iter iter = cso_hash_first_node(hash);
+
+      while (to_remove) {
+         void *cso = cso_hash_iter_data(iter);
+
+         if (!cso)
+            break;
+
+         if ((pass || iter.node->last_use <= threshold) &&
+             delete_cso(ctx, cso, type)) {
+            iter = cso_hash_erase(hash, iter);
+            ctx->cache.stats[type].evictions++;
+            --to_remove;
+         } else {
+            iter = cso_hash_iter_next(iter);
+         }
       }
    }
 
@@ -231,8 +238,11 @@ sanitize_hash(struct cso_hash *hash, enum cso_cache_type type,
       /* Put currently bound sampler states back into the hash table */
       while (to_restore--) {
          struct cso_sampler *sampler = samplers_to_restore[to_restore];
+         struct cso_hash_iter iter =
+            cso_hash_insert(hash, sampler->hash_key, sampler);
 
-         cso_hash_insert(hash, sampler->hash_key, sampler);
+         if (!cso_hash_iter_is_null(iter))
+            iter.node->last_use = ++ctx->cache.lru_clock;
       }
 
       FREE(samplers_to_restore);
@@ -511,13 +521,12 @@ cso_destroy_context(struct cso_context *ctx)
  * the data member of the cso to be the template itself.
  */
 
-enum pipe_error
-cso_set_blend(struct cso_context *ctx,
+static struct cso_blend *
+cso_get_blend(struct cso_context *ctx,
               const struct pipe_blend_state *templ)
 {
    unsigned key_size, hash_key;
    struct cso_hash_iter iter;
-   void *handle;
 
    if (templ->independent_blend_enable) {
       /* This is duplicated with the else block below because we want key_size
@@ -538,7 +547,7 @@ cso_set_blend(struct cso_context *ctx,
    if (cso_hash_iter_is_null(iter)) {
       struct cso_blend *cso = MALLOC(sizeof(struct cso_blend));
       if (!cso)
-         return PIPE_ERROR_OUT_OF_MEMORY;
+         return NULL;
 
       memset(&cso->state, 0, sizeof cso->state);
       memcpy(&cso->state, templ, key_size);
@@ -547,14 +556,24 @@ cso_set_blend(struct cso_context *ctx,
       iter = cso_insert_state(&ctx->cache, hash_key, CSO_BLEND, cso);
       if (cso_hash_iter_is_null(iter)) {
          FREE(cso);
-         return PIPE_ERROR_OUT_OF_MEMORY;
+         return NULL;
       }
 
-      handle = cso->data;
-   } else {
-      handle = ((struct cso_blend *)cso_hash_iter_data(iter))->data;
+      return cso;
    }
+   return (struct cso_blend *)cso_hash_iter_data(iter);
+}
+
 
+enum pipe_error
+cso_set_blend(struct cso_context *ctx,
+              const struct pipe_blend_state *templ)
+{
+   struct cso_blend *cso = cso_get_blend(ctx, templ);
+   if (!cso)
+      return PIPE_ERROR_OUT_OF_MEMORY;
+
+   void *handle = cso->data;
    if (ctx->blend != handle) {
       ctx->blend = handle;
       ctx->base.pipe->bind_blend_state(ctx->base.pipe, handle);
@@ -582,8 +601,8 @@ cso_restore_blend(struct cso_context *ctx)
 }
 
 
-enum pipe_error
-cso_set_depth_stencil_alpha(struct cso_context *ctx,
+static struct cso_depth_stencil_alpha *
+cso_get_depth_stencil_alpha(struct cso_context *ctx,
                             const struct pipe_depth_stencil_alpha_state *templ)
 {
    const unsigned key_size = sizeof(struct pipe_depth_stencil_alpha_state);
@@ -592,13 +611,12 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
                                                        hash_key,
                                                        CSO_DEPTH_STENCIL_ALPHA,
                                                        templ, key_size);
-   void *handle;
 
    if (cso_hash_iter_is_null(iter)) {
       struct cso_depth_stencil_alpha *cso =
          MALLOC(sizeof(struct cso_depth_stencil_alpha));
       if (!cso)
-         return PIPE_ERROR_OUT_OF_MEMORY;
+         return NULL;
 
       memcpy(&cso->state, templ, sizeof(*templ));
       cso->data = ctx->base.pipe->create_depth_stencil_alpha_state(ctx->base.pipe,
@@ -608,15 +626,25 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
                               CSO_DEPTH_STENCIL_ALPHA, cso);
       if (cso_hash_iter_is_null(iter)) {
          FREE(cso);
-         return PIPE_ERROR_OUT_OF_MEMORY;
+         return NULL;
       }
 
-      handle = cso->data;
-   } else {
-      handle = ((struct cso_depth_stencil_alpha *)
-                cso_hash_iter_data(iter))->data;
+      return cso;
    }
+   return (struct cso_depth_stencil_alpha *)cso_hash_iter_data(iter);
+}
 
+
+enum pipe_error
+cso_set_depth_stencil_alpha(struct cso_context *ctx,
+                            const struct pipe_depth_stencil_alpha_state *templ)
+{
+   struct cso_depth_stencil_alpha *cso =
+      cso_get_depth_stencil_alpha(ctx, templ);
+   if (!cso)
+      return PIPE_ERROR_OUT_OF_MEMORY;
+
+   void *handle = cso->data;
    if (ctx->depth_stencil != handle) {
       ctx->depth_stencil = handle;
       ctx->base.pipe->bind_depth_stencil_alpha_state(ctx->base.pipe, handle);
@@ -645,8 +673,8 @@ cso_restore_depth_stencil_alpha(struct cso_context *ctx)
 }
 
 
-enum pipe_error
-cso_set_rasterizer(struct cso_context *ctx,
+static struct cso_rasterizer *
+cso_get_rasterizer(struct cso_context *ctx,
                    const struct pipe_rasterizer_state *templ)
 {
    const unsigned key_size = sizeof(struct pipe_rasterizer_state);
@@ -655,7 +683,6 @@ cso_set_rasterizer(struct cso_context *ctx,
                                                        hash_key,
                                                        CSO_RASTERIZER,
                                                        templ, key_size);
-   void *handle = NULL;
 
    /* We can't have both point_quad_rasterization (sprites) and point_smooth
     * (round AA points) enabled at the same time.
@@ -665,7 +692,7 @@ cso_set_rasterizer(struct cso_context *ctx,
    if (cso_hash_iter_is_null(iter)) {
       struct cso_rasterizer *cso = MALLOC(sizeof(struct cso_rasterizer));
       if (!cso)
-         return PIPE_ERROR_OUT_OF_MEMORY;
+         return NULL;
 
       memcpy(&cso->state, templ, sizeof(*templ));
       cso->data = ctx->base.pipe->create_rasterizer_state(ctx->base.pipe, &cso->state);
@@ -673,14 +700,24 @@ cso_set_rasterizer(struct cso_context *ctx,
       iter = cso_insert_state(&ctx->cache, hash_key, CSO_RASTERIZER, cso);
       if (cso_hash_iter_is_null(iter)) {
          FREE(cso);
-         return PIPE_ERROR_OUT_OF_MEMORY;
+         return NULL;
       }
 
-      handle = cso->data;
-   } else {
-      handle = ((struct cso_rasterizer *)cso_hash_iter_data(iter))->data;
+      return cso;
    }
+   return (struct cso_rasterizer *)cso_hash_iter_data(iter);
+}
+
+
+enum pipe_error
+cso_set_rasterizer(struct cso_context *ctx,
+                   const struct pipe_rasterizer_state *templ)
+{
+   struct cso_rasterizer *cso = cso_get_rasterizer(ctx, templ);
+   if (!cso)
+      return PIPE_ERROR_OUT_OF_MEMORY;
 
+   void *handle = cso->data;
    if (ctx->rasterizer != handle) {
       ctx->rasterizer = handle;
       ctx->flatshade_first = templ->flatshade_first;
@@ -1156,9 +1193,9 @@ cso_restore_compute_samplers(struct cso_context *ctx)
 }
 
 
-static void
-cso_set_vertex_elements_direct(struct cso_context *ctx,
-                               const struct cso_velems_state *velems)
+static struct cso_velements *
+cso_get_vertex_elements(struct cso_context *ctx,
+                        const struct cso_velems_state *velems)
 {
    /* Need to include the count into the stored state data too.
     * Otherwise first few count pipe_vertex_elements could be identical
@@ -1171,12 +1208,11 @@ cso_set_vertex_elements_direct(struct cso_context *ctx,
    struct cso_hash_iter iter =
       cso_find_state_template(&ctx->cache, hash_key, CSO_VELEMENTS,
                               velems, key_size);
-   void *handle;
 
    if (cso_hash_iter_is_null(iter)) {
       struct cso_velements *cso = MALLOC(sizeof(struct cso_velements));
       if (!cso)
-         return;
+         return NULL;
 
       memcpy(&cso->state, velems, key_size);
 
@@ -1192,14 +1228,24 @@ cso_set_vertex_elements_direct(struct cso_context *ctx,
       iter = cso_insert_state(&ctx->cache, hash_key, CSO_VELEMENTS, cso);
       if (cso_hash_iter_is_null(iter)) {
          FREE(cso);
-         return;
+         return NULL;
       }
 
-      handle = cso->data;
-   } else {
-      handle = ((struct cso_velements *)cso_hash_iter_data(iter))->data;
+      return cso;
    }
+   return (struct cso_velements *)cso_hash_iter_data(iter);
+}
+
+
+static void
+cso_set_vertex_elements_direct(struct cso_context *ctx,
+                               const struct cso_velems_state *velems)
+{
+   struct cso_velements *cso = cso_get_vertex_elements(ctx, velems);
+   if (!cso)
+      return;
 
+   void *handle = cso->data;
    if (ctx->velements != handle) {
       ctx->velements = handle;
       ctx->base.pipe->bind_vertex_elements_state(ctx->base.pipe, handle);
@@ -1505,6 +1551,77 @@ cso_set_samplers(struct cso_context *ctx,
 }
 
 
+/*
+ * Create the driver objects for states that are expected to be set soon,
+ * without binding them, so that the driver doesn't have to create them
+ * during the first draw that uses them.
+ */
+enum pipe_error
+cso_precreate_blend(struct cso_context *ctx,
+                    const struct pipe_blend_state *templ)
+{
+   return cso_get_blend(ctx, templ) ? PIPE_OK : PIPE_ERROR_OUT_OF_MEMORY;
+}
+
+
+enum pipe_error
+cso_precreate_depth_stencil_alpha(struct cso_context *ctx,
+                                  const struct pipe_depth_stencil_alpha_state *templ)
+{
+   return cso_get_depth_stencil_alpha(ctx, templ) ? PIPE_OK :
+                                                    PIPE_ERROR_OUT_OF_MEMORY;
+}
+
+
+enum pipe_error
+cso_precreate_rasterizer(struct cso_context *ctx,
+                         const struct pipe_rasterizer_state *templ)
+{
+   return cso_get_rasterizer(ctx, templ) ? PIPE_OK : PIPE_ERROR_OUT_OF_MEMORY;
+}
+
+
+enum pipe_error
+cso_precreate_sampler(struct cso_context *ctx,
+                      const struct pipe_sampler_state *templ)
+{
+   struct cso_sampler *cso;
+
+   if (ctx->sampler_format) {
+      cso = set_sampler(ctx, PIPE_SHADER_FRAGMENT, 0, templ,
+                        sizeof(struct pipe_sampler_state));
+   } else {
+      cso = set_sampler(ctx, PIPE_SHADER_FRAGMENT, 0, templ,
+                        offsetof(struct pipe_sampler_state, border_color_format));
+   }
+   return cso ? PIPE_OK : PIPE_ERROR_OUT_OF_MEMORY;
+}
+
+
+enum pipe_error
+cso_precreate_vertex_elements(struct cso_context *ctx,
+                              const struct cso_velems_state *velems)
+{
+   /* u_vbuf has its own cache, which it fills when states are set. */
+   if (ctx->vbuf_current)
+      return PIPE_OK;
+
+   return cso_get_vertex_elements(ctx, velems) ? PIPE_OK :
+                                                 PIPE_ERROR_OUT_OF_MEMORY;
+}
+
+
+/**
+ * Return the hit, miss and eviction counts of the cache, indexed by
+ * cso_cache_type.
+ */
+const struct cso_cache_stats *
+cso_get_cache_stats(struct cso_context *ctx)
+{
+   return ctx->cache.stats;
+}
+
+
 static void
 cso_save_fragment_samplers(struct cso_context *ctx)
 {
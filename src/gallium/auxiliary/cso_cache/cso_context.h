@@ -101,6 +101,33 @@ enum pipe_error
 cso_set_vertex_elements(struct cso_context *ctx,
                         const struct cso_velems_state *velems);
 
+
+/* Create the driver objects for states ahead of their first use without
+ * binding them. These must be called from the thread that uses the context.
+ */
+enum pipe_error
+cso_precreate_blend(struct cso_context *cso,
+                    const struct pipe_blend_state *blend);
+
+enum pipe_error
+cso_precreate_depth_stencil_alpha(struct cso_context *cso,
+                                  const struct pipe_depth_stencil_alpha_state *dsa);
+
+enum pipe_error
+cso_precreate_rasterizer(struct cso_context *cso,
+                         const struct pipe_rasterizer_state *rasterizer);
+
+enum pipe_error
+cso_precreate_sampler(struct cso_context *cso,
+                      const struct pipe_sampler_state *sampler);
+
+enum pipe_error
+cso_precreate_vertex_elements(struct cso_context *cso,
+                              const struct cso_velems_state *velems);
+
+const struct cso_cache_stats *
+cso_get_cache_stats(struct cso_context *cso);
+
 void cso_set_vertex_buffers(struct cso_context *ctx,
                             unsigned start_slot, unsigned count,
                             unsigned unbind_trailing_count,
@@ -85,6 +85,7 @@ cso_hash_create_node(struct cso_hash *hash,
 
    node->key = akey;
    node->value = avalue;
+   node->last_use = 0;
 
    node->next = *anextNode;
    *anextNode = node;
@@ -55,6 +55,8 @@ struct cso_node {
    struct cso_node *next;
    void *value;
    unsigned key;
+   /* When the entry was last used, for LRU eviction by users of the hash. */
+   uint64_t last_use;
 };
 
 struct cso_hash_iter {
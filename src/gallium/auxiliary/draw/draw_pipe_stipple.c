@@ -109,11 +109,31 @@ emit_segment(struct draw_stage *stage, struct prim_header *header,
 }
 
 
+/**
+ * Return the state of the stipple pattern at pixel 'counter' and, in
+ * '*run', the number of pixels from 'counter' on for which the pattern
+ * keeps that state.
+ */
 static inline bool
-stipple_test(unsigned counter, uint16_t pattern, uint16_t factor)
+stipple_run(unsigned counter, uint16_t pattern, uint16_t factor,
+            unsigned *run)
 {
    unsigned b = (counter / factor) & 0xf;
-   return !!((1 << b) & pattern);
+   /* the pattern repeated twice, starting at bit b */
+   uint32_t bits = ((uint32_t)pattern | ((uint32_t)pattern << 16)) >> b;
+   bool result = bits & 1;
+   unsigned nbits;
+
+   if (result)
+      bits = ~bits;
+
+   /* Count the pattern bits equal to the current one.  A constant pattern
+    * never changes state, any run length is correct for it then.
+    */
+   nbits = bits ? ffs(bits) - 1 : 16;
+
+   *run = nbits * factor - counter % factor;
+   return result;
 }
 
 
@@ -137,6 +157,7 @@ stipple_line(struct draw_stage *stage, struct prim_header *header)
    float length;
    int i;
    int intlength;
+   unsigned run;
 
    if (header->flags & DRAW_PIPE_RESET_STIPPLE)
       stipple->counter = 0;
@@ -156,11 +177,12 @@ stipple_line(struct draw_stage *stage, struct prim_header *header)
    else
       intlength = ceilf(length);
 
-   /* XXX ToDo: instead of iterating pixel-by-pixel, use a look-up table.
+   /* Walk the line one run of equal pattern bits at a time rather than
+    * pixel by pixel.
     */
-   for (i = 0; i < intlength; i++) {
-      bool result = stipple_test(stipple->counter + i,
-                                 stipple->pattern, stipple->factor);
+   for (i = 0; i < intlength; i += run) {
+      bool result = stipple_run(stipple->counter + i,
+                                stipple->pattern, stipple->factor, &run);
       if (result != state) {
          /* changing from "off" to "on" or vice versa */
          if (state) {
@@ -110,6 +110,10 @@ enum LLVM_CodeGenOpt_Level {
 /**
  * Create the LLVM (optimization) pass manager and install
  * relevant optimization passes.
+ *
+ * This is skipped when the module's machine code was found in the shader
+ * cache, so that loading cached shaders doesn't pay for setting up passes
+ * which never run.
  * \return  TRUE for success, FALSE for failure
  */
 static bool
@@ -117,7 +121,6 @@ create_pass_manager(struct gallivm_state *gallivm)
 {
 #if GALLIVM_USE_NEW_PASS == 0
    assert(!gallivm->passmgr);
-   assert(gallivm->target);
 
    gallivm->passmgr = LLVMCreateFunctionPassManagerForModule(gallivm->module);
    if (!gallivm->passmgr)
@@ -132,14 +135,6 @@ create_pass_manager(struct gallivm_state *gallivm)
     * simple, or constant propagation into them, etc.
     */
 
-   {
-      char *td_str;
-      // New ones from the Module.
-      td_str = LLVMCopyStringRepOfTargetData(gallivm->target);
-      LLVMSetDataLayout(gallivm->module, td_str);
-      free(td_str);
-   }
-
 #if GALLIVM_HAVE_CORO == 1
 #if LLVM_VERSION_MAJOR <= 8 && (DETECT_ARCH_AARCH64 || DETECT_ARCH_ARM || DETECT_ARCH_S390 || DETECT_ARCH_MIPS64)
    LLVMAddArgumentPromotionPass(gallivm->cgpassmgr);
@@ -408,8 +403,20 @@ init_gallivm_state(struct gallivm_state *gallivm, const char *name,
       }
    }
 
-   if (!create_pass_manager(gallivm))
-      goto fail;
+#if GALLIVM_USE_NEW_PASS == 0
+   {
+      char *td_str;
+      // New ones from the Module.
+      td_str = LLVMCopyStringRepOfTargetData(gallivm->target);
+      LLVMSetDataLayout(gallivm->module, td_str);
+      free(td_str);
+   }
+#endif
+
+   if (!cache || !cache->data_size) {
+      if (!create_pass_manager(gallivm))
+         goto fail;
+   }
 
    lp_build_coro_declare_malloc_hooks(gallivm);
    return true;
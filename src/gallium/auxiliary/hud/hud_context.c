@@ -1315,6 +1315,26 @@ hud_parse_env_var(struct hud_context *hud, struct pipe_screen *screen,
       else if (strcmp(name, "main-thread-busy") == 0) {
          hud_thread_busy_install(pane, name, true);
       }
+      else if (strcmp(name, "cso-cache-hits") == 0) {
+         hud_cso_cache_install(pane, name,
+                               offsetof(struct cso_cache_stats, hits));
+      }
+      else if (strcmp(name, "cso-cache-misses") == 0) {
+         hud_cso_cache_install(pane, name,
+                               offsetof(struct cso_cache_stats, misses));
+      }
+      else if (strcmp(name, "cso-cache-evictions") == 0) {
+         hud_cso_cache_install(pane, name,
+                               offsetof(struct cso_cache_stats, evictions));
+      }
+      else if (strcmp(name, "st-validate-time") == 0) {
+         hud_atom_time_install(pane, name, NULL);
+         pane->type = PIPE_DRIVER_QUERY_TYPE_MICROSECONDS;
+      }
+      else if (strncmp(name, "st-atom-time-", 13) == 0) {
+         hud_atom_time_install(pane, name, name + 13);
+         pane->type = PIPE_DRIVER_QUERY_TYPE_MICROSECONDS;
+      }
 #ifdef HAVE_GALLIUM_EXTRA_HUD
       else if (sscanf(name, "nic-rx-%s", arg_name) == 1) {
          hud_nic_graph_install(pane, arg_name, NIC_DIRECTION_RX);
@@ -1617,6 +1637,12 @@ print_help(struct pipe_screen *screen)
    for (i = 0; i < num_cpus; i++)
       printf("    cpu%i\n", i);
 
+   puts("    cso-cache-hits");
+   puts("    cso-cache-misses");
+   puts("    cso-cache-evictions");
+   puts("    st-validate-time");
+   puts("    st-atom-time-<atom> (e.g. st-atom-time-update_fp)");
+
    if (has_occlusion_query(screen))
       puts("    samples-passed");
    if (has_streamout(screen))
@@ -2076,3 +2102,23 @@ hud_add_queue_for_monitoring(struct hud_context *hud,
    assert(!hud->monitored_queue);
    hud->monitored_queue = queue_info;
 }
+
+/**
+ * Set the per-atom validation times for the st-*-time graphs. Only the first
+ * context of a shared HUD provides them.
+ */
+void
+hud_add_atom_timing(struct hud_context *hud, struct st_atom_timing *timing)
+{
+   if (!hud->atom_timing)
+      hud->atom_timing = timing;
+}
+
+void
+hud_remove_atom_timing(struct hud_context *hud, struct st_atom_timing *timing)
+{
+   if (hud->atom_timing == timing) {
+      timing->enabled = false;
+      hud->atom_timing = NULL;
+   }
+}
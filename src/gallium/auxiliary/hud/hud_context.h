@@ -33,6 +33,7 @@ struct cso_context;
 struct pipe_context;
 struct pipe_resource;
 struct util_queue_monitoring;
+struct st_atom_timing;
 struct st_context;
 
 typedef void (*hud_st_invalidate_state_func)(struct st_context *st,
@@ -57,4 +58,10 @@ void
 hud_add_queue_for_monitoring(struct hud_context *hud,
                              struct util_queue_monitoring *queue_info);
 
+void
+hud_add_atom_timing(struct hud_context *hud, struct st_atom_timing *timing);
+
+void
+hud_remove_atom_timing(struct hud_context *hud, struct st_atom_timing *timing);
+
 #endif
@@ -29,6 +29,8 @@
  */
 
 #include "hud/hud_private.h"
+#include "frontend/api.h"
+#include "cso_cache/cso_context.h"
 #include "util/os_time.h"
 #include "util/u_thread.h"
 #include "util/u_memory.h"
@@ -474,3 +476,165 @@ void hud_thread_counter_install(struct hud_pane *pane, const char *name,
    hud_pane_add_graph(pane, gr);
    hud_pane_set_max_value(pane, 100);
 }
+
+struct cso_cache_info {
+   size_t counter; /* offset in struct cso_cache_stats */
+   uint64_t last_value;
+   int64_t last_time;
+};
+
+static uint64_t
+get_cso_cache_counter(struct cso_context *cso, size_t counter)
+{
+   const struct cso_cache_stats *stats = cso_get_cache_stats(cso);
+   uint64_t value = 0;
+
+   for (unsigned i = 0; i < CSO_CACHE_MAX; i++)
+      value += *(const unsigned *)((const char *)&stats[i] + counter);
+   return value;
+}
+
+static void
+query_cso_cache(struct hud_graph *gr, struct pipe_context *pipe)
+{
+   struct cso_cache_info *info = gr->query_data;
+   struct cso_context *cso = gr->pane->hud->cso;
+   int64_t now = os_time_get_nano();
+
+   if (!cso)
+      return;
+
+   uint64_t value = get_cso_cache_counter(cso, info->counter);
+
+   /* The counters start over if the HUD is moved to another context. */
+   if (info->last_time && value >= info->last_value) {
+      if (info->last_time + gr->pane->period*1000 <= now) {
+         hud_graph_add_value(gr, value - info->last_value);
+         info->last_value = value;
+         info->last_time = now;
+      }
+   } else {
+      /* initialize */
+      info->last_value = value;
+      info->last_time = now;
+   }
+}
+
+void
+hud_cso_cache_install(struct hud_pane *pane, const char *name, size_t counter)
+{
+   struct hud_graph *gr = CALLOC_STRUCT(hud_graph);
+   if (!gr)
+      return;
+
+   snprintf(gr->name, sizeof(gr->name), "%s", name);
+
+   struct cso_cache_info *info = CALLOC_STRUCT(cso_cache_info);
+   if (!info) {
+      FREE(gr);
+      return;
+   }
+
+   info->counter = counter;
+
+   gr->query_data = info;
+   gr->query_new_value = query_cso_cache;
+
+   /* Don't use free() as our callback as that messes up Gallium's
+    * memory debugger.  Use simple free_query_data() wrapper.
+    */
+   gr->free_query_data = free_query_data;
+
+   hud_pane_add_graph(pane, gr);
+}
+
+struct atom_time_info {
+   char atom[64]; /* empty for all atoms */
+   int atom_index; /* -1 if not found yet */
+   uint64_t last_ns;
+   int64_t last_time;
+};
+
+static uint64_t
+get_atom_time(struct st_atom_timing *timing, struct atom_time_info *info)
+{
+   uint64_t ns = 0;
+
+   if (!info->atom[0]) {
+      for (unsigned i = 0; i < timing->num_atoms; i++)
+         ns += timing->time_ns[i];
+      return ns;
+   }
+
+   if (info->atom_index < 0) {
+      for (unsigned i = 0; i < timing->num_atoms; i++) {
+         if (strcmp(timing->names[i], info->atom) == 0) {
+            info->atom_index = i;
+            break;
+         }
+      }
+      if (info->atom_index < 0)
+         return 0;
+   }
+
+   return timing->time_ns[info->atom_index];
+}
+
+static void
+query_atom_time(struct hud_graph *gr, struct pipe_context *pipe)
+{
+   struct atom_time_info *info = gr->query_data;
+   struct st_atom_timing *timing = gr->pane->hud->atom_timing;
+   int64_t now = os_time_get_nano();
+
+   if (!timing)
+      return;
+
+   /* The counters are only updated while someone is looking at them. */
+   timing->enabled = true;
+
+   uint64_t ns = get_atom_time(timing, info);
+
+   if (info->last_time) {
+      if (info->last_time + gr->pane->period*1000 <= now) {
+         hud_graph_add_value(gr, (ns - info->last_ns) / 1000);
+         info->last_ns = ns;
+         info->last_time = now;
+      }
+   } else {
+      /* initialize */
+      info->last_ns = ns;
+      info->last_time = now;
+   }
+}
+
+void
+hud_atom_time_install(struct hud_pane *pane, const char *name,
+                      const char *atom)
+{
+   struct hud_graph *gr = CALLOC_STRUCT(hud_graph);
+   if (!gr)
+      return;
+
+   snprintf(gr->name, sizeof(gr->name), "%s", name);
+
+   struct atom_time_info *info = CALLOC_STRUCT(atom_time_info);
+   if (!info) {
+      FREE(gr);
+      return;
+   }
+
+   if (atom)
+      snprintf(info->atom, sizeof(info->atom), "%s", atom);
+   info->atom_index = -1;
+
+   gr->query_data = info;
+   gr->query_new_value = query_atom_time;
+
+   /* Don't use free() as our callback as that messes up Gallium's
+    * memory debugger.  Use simple free_query_data() wrapper.
+    */
+   gr->free_query_data = free_query_data;
+
+   hud_pane_add_graph(pane, gr);
+}
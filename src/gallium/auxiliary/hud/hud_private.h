@@ -61,6 +61,7 @@ struct hud_context {
    struct list_head pane_list;
 
    struct util_queue_monitoring *monitored_queue;
+   struct st_atom_timing *atom_timing;
 
    /* states */
    struct pipe_blend_state no_blend, alpha_blend;
@@ -170,6 +171,10 @@ void hud_cpu_graph_install(struct hud_pane *pane, unsigned cpu_index);
 void hud_thread_busy_install(struct hud_pane *pane, const char *name, bool main);
 void hud_thread_counter_install(struct hud_pane *pane, const char *name,
                                 enum hud_counter counter);
+void hud_cso_cache_install(struct hud_pane *pane, const char *name,
+                           size_t counter);
+void hud_atom_time_install(struct hud_pane *pane, const char *name,
+                           const char *atom);
 void hud_pipe_query_install(struct hud_batch_query_context **pbq,
                             struct hud_pane *pane,
                             const char *name,
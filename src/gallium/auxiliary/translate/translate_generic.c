@@ -73,6 +73,11 @@ struct translate_generic {
        */
       int copy_size;
 
+      /* the size of one element in bytes, or 0 if the format isn't a plain
+       * array of bytes
+       */
+      unsigned input_size;
+
    } attrib[TRANSLATE_MAX_ATTRIBS];
 
    unsigned nr_attrib;
@@ -584,73 +589,143 @@ get_emit_func(enum pipe_format format)
    }
 }
 
-static ALWAYS_INLINE void UTIL_CDECL
-generic_run_one(struct translate_generic *tg,
-                unsigned elt,
-                unsigned start_instance,
-                unsigned instance_id,
-                void *vert,
-                unsigned index_size)
+/* The number of vertices converted at a time, one attribute after another. */
+#define GENERIC_CHUNK_SIZE 64
+
+/**
+ * Fetch vertex attributes for up to GENERIC_CHUNK_SIZE vertices.
+ *
+ * This loops over vertices for each attribute rather than the other way
+ * around, so that the per-attribute setup happens once per chunk, and
+ * attributes that are tightly packed in their buffer can be unpacked with
+ * a single call.
+ */
+static ALWAYS_INLINE void
+generic_run_chunk(struct translate_generic *tg,
+                  const void *elts,
+                  unsigned start,
+                  unsigned count,
+                  unsigned start_instance,
+                  unsigned instance_id,
+                  uint8_t *vert,
+                  unsigned index_size)
 {
+   const unsigned output_stride = tg->translate.key.output_stride;
    unsigned nr_attrs = tg->nr_attrib;
-   unsigned attr;
+   unsigned attr, i;
+
+   assert(count <= GENERIC_CHUNK_SIZE);
 
    for (attr = 0; attr < nr_attrs; attr++) {
-      float data[4];
-      uint8_t *dst = (uint8_t *)vert + tg->attrib[attr].output_offset;
-
-      if (tg->attrib[attr].type == TRANSLATE_ELEMENT_NORMAL) {
-         const uint8_t *src;
-         unsigned index;
-         int copy_size;
-
-         if (tg->attrib[attr].instance_divisor) {
-            index = start_instance;
-            index += (instance_id  / tg->attrib[attr].instance_divisor);
-            /* XXX we need to clamp the index here too, but to a
-             * per-array max value, not the draw->pt.max_index value
-             * that's being given to us via translate->set_buffer().
-             */
-         }
-         else {
-            index = elt;
-            if (index_size > 0) {
-               /* clamp to avoid going out of bounds */
-               index = MIN2(index, tg->attrib[attr].max_index);
-            }
+      float data[GENERIC_CHUNK_SIZE][4];
+      uint8_t *dst = vert + tg->attrib[attr].output_offset;
+      int copy_size = tg->attrib[attr].copy_size;
+
+      if (tg->attrib[attr].type != TRANSLATE_ELEMENT_NORMAL) {
+         if (likely(copy_size >= 0)) {
+            for (i = 0; i < count; i++)
+               memcpy(dst + i * output_stride, &instance_id, 4);
+         } else {
+            data[0][0] = (float)instance_id;
+            for (i = 0; i < count; i++)
+               tg->attrib[attr].emit(data[0], dst + i * output_stride);
          }
+         continue;
+      }
+
+      const uint8_t *input_ptr = tg->attrib[attr].input_ptr;
+      const unsigned input_stride = tg->attrib[attr].input_stride;
 
-         src = tg->attrib[attr].input_ptr +
-               (ptrdiff_t)tg->attrib[attr].input_stride * index;
+      if (tg->attrib[attr].instance_divisor) {
+         /* The same element is used for all vertices. */
+         unsigned index = start_instance +
+                          instance_id / tg->attrib[attr].instance_divisor;
+         /* XXX we need to clamp the index here too, but to a
+          * per-array max value, not the draw->pt.max_index value
+          * that's being given to us via translate->set_buffer().
+          */
+         const uint8_t *src = input_ptr + (ptrdiff_t)input_stride * index;
 
-         copy_size = tg->attrib[attr].copy_size;
          if (likely(copy_size >= 0)) {
-            memcpy(dst, src, copy_size);
+            for (i = 0; i < count; i++)
+               memcpy(dst + i * output_stride, src, copy_size);
          } else {
-            tg->attrib[attr].fetch(data, src, 1);
-
-            if (0)
-               debug_printf("Fetch linear attr %d  from %p  stride %d  index %d: "
-                         " %f, %f, %f, %f \n",
-                         attr,
-                         tg->attrib[attr].input_ptr,
-                         tg->attrib[attr].input_stride,
-                         index,
-                         data[0], data[1],data[2], data[3]);
-
-            tg->attrib[attr].emit(data, dst);
+            tg->attrib[attr].fetch(data[0], src, 1);
+            for (i = 0; i < count; i++)
+               tg->attrib[attr].emit(data[0], dst + i * output_stride);
          }
+         continue;
+      }
+
+      if (!index_size && input_stride == tg->attrib[attr].input_size &&
+          copy_size < 0) {
+         /* Consecutive vertices are packed, so unpack them all at once. */
+         tg->attrib[attr].fetch(data[0],
+                                input_ptr + (ptrdiff_t)input_stride * start,
+                                count);
+         for (i = 0; i < count; i++)
+            tg->attrib[attr].emit(data[i], dst + i * output_stride);
       } else {
-         if (likely(tg->attrib[attr].copy_size >= 0)) {
-            memcpy(data, &instance_id, 4);
-         } else {
-            data[0] = (float)instance_id;
-            tg->attrib[attr].emit(data, dst);
+         for (i = 0; i < count; i++) {
+            unsigned index;
+
+            switch (index_size) {
+            case 4:
+               index = MIN2(((const unsigned *)elts)[i],
+                            tg->attrib[attr].max_index);
+               break;
+            case 2:
+               index = MIN2(((const uint16_t *)elts)[i],
+                            tg->attrib[attr].max_index);
+               break;
+            case 1:
+               index = MIN2(((const uint8_t *)elts)[i],
+                            tg->attrib[attr].max_index);
+               break;
+            default:
+               index = start + i;
+               break;
+            }
+
+            const uint8_t *src = input_ptr + (ptrdiff_t)input_stride * index;
+
+            if (likely(copy_size >= 0)) {
+               memcpy(dst + i * output_stride, src, copy_size);
+            } else {
+               tg->attrib[attr].fetch(data[0], src, 1);
+               tg->attrib[attr].emit(data[0], dst + i * output_stride);
+            }
          }
       }
    }
 }
 
+static ALWAYS_INLINE void
+generic_run_range(struct translate_generic *tg,
+                  const void *elts,
+                  unsigned start,
+                  unsigned count,
+                  unsigned start_instance,
+                  unsigned instance_id,
+                  void *output_buffer,
+                  unsigned index_size)
+{
+   uint8_t *vert = output_buffer;
+
+   while (count) {
+      unsigned n = MIN2(count, GENERIC_CHUNK_SIZE);
+
+      generic_run_chunk(tg, elts, start, n, start_instance, instance_id,
+                        vert, index_size);
+
+      if (index_size)
+         elts = (const uint8_t *)elts + n * index_size;
+      start += n;
+      count -= n;
+      vert += n * tg->translate.key.output_stride;
+   }
+}
+
 /**
  * Fetch vertex attributes for 'count' vertices.
  */
@@ -662,14 +737,8 @@ generic_run_elts(struct translate *translate,
                  unsigned instance_id,
                  void *output_buffer)
 {
-   struct translate_generic *tg = translate_generic(translate);
-   char *vert = output_buffer;
-   unsigned i;
-
-   for (i = 0; i < count; i++) {
-      generic_run_one(tg, *elts++, start_instance, instance_id, vert, 4);
-      vert += tg->translate.key.output_stride;
-   }
+   generic_run_range(translate_generic(translate), elts, 0, count,
+                     start_instance, instance_id, output_buffer, 4);
 }
 
 static void UTIL_CDECL
@@ -680,14 +749,8 @@ generic_run_elts16(struct translate *translate,
                    unsigned instance_id,
                    void *output_buffer)
 {
-   struct translate_generic *tg = translate_generic(translate);
-   char *vert = output_buffer;
-   unsigned i;
-
-   for (i = 0; i < count; i++) {
-      generic_run_one(tg, *elts++, start_instance, instance_id, vert, 2);
-      vert += tg->translate.key.output_stride;
-   }
+   generic_run_range(translate_generic(translate), elts, 0, count,
+                     start_instance, instance_id, output_buffer, 2);
 }
 
 static void UTIL_CDECL
@@ -698,14 +761,8 @@ generic_run_elts8(struct translate *translate,
                   unsigned instance_id,
                   void *output_buffer)
 {
-   struct translate_generic *tg = translate_generic(translate);
-   char *vert = output_buffer;
-   unsigned i;
-
-   for (i = 0; i < count; i++) {
-      generic_run_one(tg, *elts++, start_instance, instance_id, vert, 1);
-      vert += tg->translate.key.output_stride;
-   }
+   generic_run_range(translate_generic(translate), elts, 0, count,
+                     start_instance, instance_id, output_buffer, 1);
 }
 
 static void UTIL_CDECL
@@ -716,14 +773,8 @@ generic_run(struct translate *translate,
             unsigned instance_id,
             void *output_buffer)
 {
-   struct translate_generic *tg = translate_generic(translate);
-   char *vert = output_buffer;
-   unsigned i;
-
-   for (i = 0; i < count; i++) {
-      generic_run_one(tg, start + i, start_instance, instance_id, vert, 0);
-      vert += tg->translate.key.output_stride;
-   }
+   generic_run_range(translate_generic(translate), NULL, start, count,
+                     start_instance, instance_id, output_buffer, 0);
 }
 
 
@@ -822,6 +873,11 @@ translate_generic_create(const struct translate_key *key)
 
       tg->attrib[i].output_offset = key->element[i].output_offset;
 
+      if (format_desc->block.width == 1 &&
+          format_desc->block.height == 1 &&
+          !(format_desc->block.bits & 7))
+         tg->attrib[i].input_size = format_desc->block.bits >> 3;
+
       tg->attrib[i].copy_size = -1;
       if (tg->attrib[i].type == TRANSLATE_ELEMENT_INSTANCE_ID) {
          if (key->element[i].output_format == PIPE_FORMAT_R32_USCALED
@@ -29,6 +29,7 @@
 #include "util/format/u_format.h"
 #include "util/u_inlines.h"
 #include "util/u_memory.h"
+#include "util/os_time.h"
 #include "util/u_upload_mgr.h"
 #include "driver_trace/tr_context.h"
 #include "util/log.h"
@@ -88,7 +89,7 @@ static void
 tc_batch_check(UNUSED struct tc_batch *batch)
 {
    tc_assert(batch->sentinel == TC_SENTINEL);
-   tc_assert(batch->num_total_slots <= TC_SLOTS_PER_BATCH);
+   tc_assert(batch->num_total_slots <= batch->max_slots);
 }
 
 static void
@@ -380,6 +381,8 @@ batch_execute(struct tc_batch *batch, struct pipe_context *pipe, uint64_t *last,
     * begin incrementing renderpass info on the first set_framebuffer_state call
     */
    bool first = !batch->first_set_fb;
+   unsigned num_merged_draws = 0;
+
    for (uint64_t *iter = batch->slots; iter != last;) {
       struct tc_call_base *call = (struct tc_call_base *)iter;
 
@@ -391,7 +394,12 @@ batch_execute(struct tc_batch *batch, struct pipe_context *pipe, uint64_t *last,
 
       TC_TRACE_SCOPE(call->call_id);
 
-      iter += execute_func[call->call_id](pipe, call, last);
+      uint16_t num_slots = execute_func[call->call_id](pipe, call, last);
+
+      /* Only merged draws consume the calls following them. */
+      if (unlikely(num_slots > call->num_slots))
+         num_merged_draws += num_slots / call->num_slots - 1;
+      iter += num_slots;
 
       if (parsing) {
          if (call->call_id == TC_CALL_flush) {
@@ -415,6 +423,9 @@ batch_execute(struct tc_batch *batch, struct pipe_context *pipe, uint64_t *last,
          }
       }
    }
+
+   if (num_merged_draws)
+      p_atomic_add(&batch->tc->num_merged_draws, num_merged_draws);
 }
 
 static void
@@ -493,17 +504,72 @@ tc_begin_next_buffer_list(struct threaded_context *tc)
    tc->add_all_compute_bindings_to_buffer_list = true;
 }
 
+/* Grow the storage of an idle batch to the current batch size. */
+static void
+tc_batch_resize(struct threaded_context *tc, struct tc_batch *batch)
+{
+   tc_assert(util_queue_fence_is_signalled(&batch->fence));
+   tc_assert(batch->num_total_slots == 0);
+
+   if (batch->max_slots >= tc->batch_max_slots)
+      return;
+
+   /* The batch is empty, so there is nothing to preserve. */
+   uint64_t *slots = MALLOC(tc->batch_max_slots * sizeof(batch->slots[0]));
+   if (!slots)
+      return;
+
+   FREE(batch->slots);
+   batch->slots = slots;
+   batch->max_slots = tc->batch_max_slots;
+}
+
 static void
 tc_batch_flush(struct threaded_context *tc, bool full_copy)
 {
    struct tc_batch *next = &tc->batch_slots[tc->next];
    unsigned next_id = (tc->next + 1) % TC_MAX_BATCHES;
+   struct tc_batch *oldest = &tc->batch_slots[next_id];
+
+   MESA_TRACE_FUNC();
 
    tc_assert(next->num_total_slots != 0);
    tc_batch_check(next);
    tc_debug_check(tc);
    tc->bytes_mapped_estimate = 0;
    p_atomic_add(&tc->num_offloaded_slots, next->num_total_slots);
+   p_atomic_inc(&tc->num_batches);
+
+   /* Adapt the flush threshold to the balance between the threads. If the
+    * driver thread has already executed everything we gave it, it's waiting
+    * for us, so flush smaller batches to feed it sooner. If batches are
+    * queued up, the driver thread is the bottleneck, so use bigger batches
+    * to minimize the queue overhead.
+    */
+   if (util_queue_fence_is_signalled(&tc->batch_slots[tc->last].fence)) {
+      tc->batch_limit = MAX2(tc->batch_limit / 2, TC_MIN_SLOTS_PER_BATCH);
+   } else {
+      tc->batch_limit = MIN2(tc->batch_limit * 2, tc->batch_max_slots);
+   }
+
+   /* If all other batches are queued or executing, the queue is full and
+    * we have to wait for the oldest batch. This is what util_queue_add_job
+    * would do, but doing it here lets us measure it. Make the batches
+    * bigger when they are reused, so that more work can be queued ahead of
+    * the driver thread before the next stall.
+    */
+   if (!util_queue_fence_is_signalled(&oldest->fence)) {
+      int64_t start = os_time_get_nano();
+
+      MESA_TRACE_BEGIN("tc stall");
+      util_queue_fence_wait(&oldest->fence);
+      MESA_TRACE_END();
+
+      p_atomic_inc(&tc->num_stalls);
+      p_atomic_add(&tc->stall_time_ns, os_time_get_nano() - start);
+      tc->batch_max_slots = MIN2(tc->batch_max_slots * 2,
+                                 TC_MAX_SLOTS_PER_BATCH);
+   }
 
    if (next->token) {
       next->token->tc = NULL;
@@ -524,8 +590,9 @@ tc_batch_flush(struct threaded_context *tc, bool full_copy)
                       NULL, 0);
    tc->last = tc->next;
    tc->next = next_id;
+   tc_batch_resize(tc, oldest);
+   tc->batch_limit = MIN2(tc->batch_limit, oldest->max_slots);
    tc_begin_next_buffer_list(tc);
-
 }
 
 /* This is the function that adds variable-sized calls into the current
@@ -538,10 +605,14 @@ tc_add_sized_call(struct threaded_context *tc, enum tc_call_id id,
 {
    TC_TRACE_SCOPE(id);
    struct tc_batch *next = &tc->batch_slots[tc->next];
-   assert(num_slots <= TC_SLOTS_PER_BATCH);
+   /* Only split draws fill the rest of a bigger batch. */
+   assert(num_slots <= TC_SLOTS_PER_BATCH ||
+          next->num_total_slots + num_slots <= tc->batch_limit);
    tc_debug_check(tc);
 
-   if (unlikely(next->num_total_slots + num_slots > TC_SLOTS_PER_BATCH)) {
+   /* Calls larger than the flush threshold go into an empty batch. */
+   if (unlikely(next->num_total_slots + num_slots > tc->batch_limit &&
+                next->num_total_slots)) {
       /* copy existing renderpass info during flush */
       tc_batch_flush(tc, true);
       next = &tc->batch_slots[tc->next];
@@ -607,7 +678,7 @@ tc_enlarge_last_mergeable_call(struct threaded_context *tc, unsigned desired_num
 
    unsigned added_slots = desired_num_slots - call->num_slots;
 
-   if (unlikely(batch->num_total_slots + added_slots > TC_SLOTS_PER_BATCH))
+   if (unlikely(batch->num_total_slots + added_slots > tc->batch_limit))
       return false;
 
    batch->num_total_slots += added_slots;
@@ -1306,6 +1377,17 @@ tc_render_condition(struct pipe_context *_pipe,
  * constant (immutable) states
  */
 
+static void
+tc_forget_sampler_state(struct threaded_context *tc, void *state)
+{
+   for (unsigned i = 0; i < PIPE_SHADER_TYPES; i++) {
+      for (unsigned j = 0; j < PIPE_MAX_SAMPLERS; j++) {
+         if (tc->bound_samplers[i][j] == state)
+            tc->bound_samplers[i][j] = NULL;
+      }
+   }
+}
+
 #define TC_CSO_CREATE(name, sname) \
    static void * \
    tc_create_##name##_state(struct pipe_context *_pipe, \
@@ -1315,8 +1397,40 @@ tc_render_condition(struct pipe_context *_pipe,
       return pipe->create_##name##_state(pipe, state); \
    }
 
-#define TC_CSO_BIND(name, ...) TC_FUNC1(bind_##name##_state, , void *, , , ##__VA_ARGS__)
-#define TC_CSO_DELETE(name) TC_FUNC1(delete_##name##_state, , void *, , )
+/* Binding the CSO that is already bound is skipped. The extra code is
+ * executed in both cases.
+ */
+#define TC_CSO_BIND(name, ...) \
+   struct tc_call_bind_##name##_state { \
+      struct tc_call_base base; \
+      void *state; \
+   }; \
+   \
+   static uint16_t \
+   tc_call_bind_##name##_state(struct pipe_context *pipe, void *call, uint64_t *last) \
+   { \
+      pipe->bind_##name##_state(pipe, to_call(call, tc_call_bind_##name##_state)->state); \
+      return call_size(tc_call_bind_##name##_state); \
+   } \
+   \
+   static void \
+   tc_bind_##name##_state(struct pipe_context *_pipe, void *param) \
+   { \
+      struct threaded_context *tc = threaded_context(_pipe); \
+      if (param && param == tc->bound_cso.name) { \
+         tc->num_elided_calls++; \
+      } else { \
+         struct tc_call_bind_##name##_state *p = \
+            tc_add_call(tc, TC_CALL_bind_##name##_state, tc_call_bind_##name##_state); \
+         p->state = param; \
+         tc->bound_cso.name = param; \
+      } \
+      __VA_ARGS__; \
+   }
+
+#define TC_CSO_DELETE(name) TC_FUNC1(delete_##name##_state, , void *, , , \
+   if (tc->bound_cso.name == param) \
+      tc->bound_cso.name = NULL)
 
 #define TC_CSO(name, sname, ...) \
    TC_CSO_CREATE(name, sname) \
@@ -1365,7 +1479,7 @@ TC_CSO_SHADER_TRACK(gs)
 TC_CSO_SHADER_TRACK(tcs)
 TC_CSO_SHADER_TRACK(tes)
 TC_CSO_CREATE(sampler, sampler)
-TC_CSO_DELETE(sampler)
+TC_FUNC1(delete_sampler_state, , void *, , , tc_forget_sampler_state(tc, param))
 TC_CSO_BIND(vertex_elements)
 TC_CSO_DELETE(vertex_elements)
 
@@ -1402,6 +1516,15 @@ tc_bind_sampler_states(struct pipe_context *_pipe,
       return;
 
    struct threaded_context *tc = threaded_context(_pipe);
+   void **bound = &tc->bound_samplers[shader][start];
+   unsigned i;
+
+   for (i = 0; i < count && states[i] && states[i] == bound[i]; i++);
+   if (i == count) {
+      tc->num_elided_calls++;
+      return;
+   }
+
    struct tc_sampler_states *p =
       tc_add_slot_based_call(tc, TC_CALL_bind_sampler_states, tc_sampler_states, count);
 
@@ -1409,6 +1532,7 @@ tc_bind_sampler_states(struct pipe_context *_pipe,
    p->start = start;
    p->count = count;
    memcpy(p->slot, states, count * sizeof(states[0]));
+   memcpy(bound, states, count * sizeof(states[0]));
 }
 
 static void
@@ -1594,6 +1718,19 @@ tc_set_constant_buffer(struct pipe_context *_pipe,
       p->index = index;
       p->is_null = true;
       tc_unbind_buffer(&tc->const_buffers[shader][index]);
+      tc->bound_const_buffers[shader][index].buffer = NULL;
+      return;
+   }
+
+   if (cb->buffer &&
+       cb->buffer == tc->bound_const_buffers[shader][index].buffer &&
+       cb->buffer_offset == tc->bound_const_buffers[shader][index].offset &&
+       cb->buffer_size == tc->bound_const_buffers[shader][index].size) {
+      if (take_ownership) {
+         struct pipe_resource *buffer = cb->buffer;
+         pipe_resource_reference(&buffer, NULL);
+      }
+      tc->num_elided_calls++;
       return;
    }
 
@@ -1635,6 +1772,11 @@ tc_set_constant_buffer(struct pipe_context *_pipe,
    } else {
       tc_unbind_buffer(&tc->const_buffers[shader][index]);
    }
+
+   /* Uploaded user buffers are never bound again. */
+   tc->bound_const_buffers[shader][index].buffer = cb->user_buffer ? NULL : buffer;
+   tc->bound_const_buffers[shader][index].offset = offset;
+   tc->bound_const_buffers[shader][index].size = cb->buffer_size;
 }
 
 struct tc_inlinable_constants {
@@ -1812,6 +1954,24 @@ tc_set_sampler_views(struct pipe_context *_pipe,
       return;
 
    struct threaded_context *tc = threaded_context(_pipe);
+   struct pipe_sampler_view **bound = &tc->bound_sampler_views[shader][start];
+
+   if (views && !unbind_num_trailing_slots) {
+      unsigned i;
+
+      for (i = 0; i < count && views[i] && views[i] == bound[i]; i++);
+      if (i == count) {
+         if (take_ownership) {
+            for (i = 0; i < count; i++) {
+               struct pipe_sampler_view *view = views[i];
+               pipe_sampler_view_reference(&view, NULL);
+            }
+         }
+         tc->num_elided_calls++;
+         return;
+      }
+   }
+
    struct tc_sampler_views *p =
       tc_add_slot_based_call(tc, TC_CALL_set_sampler_views, tc_sampler_views,
                              views ? count : 0);
@@ -1853,12 +2013,16 @@ tc_set_sampler_views(struct pipe_context *_pipe,
       tc_unbind_buffers(&tc->sampler_buffers[shader][start + count],
                         unbind_num_trailing_slots);
       tc->seen_sampler_buffers[shader] = true;
+
+      memcpy(bound, views, sizeof(*views) * count);
+      memset(bound + count, 0, sizeof(*views) * unbind_num_trailing_slots);
    } else {
       p->count = 0;
       p->unbind_num_trailing_slots = count + unbind_num_trailing_slots;
 
       tc_unbind_buffers(&tc->sampler_buffers[shader][start],
                         count + unbind_num_trailing_slots);
+      memset(bound, 0, sizeof(*views) * (count + unbind_num_trailing_slots));
    }
 }
 
@@ -3476,6 +3640,15 @@ tc_call_flush(struct pipe_context *pipe, void *call, uint64_t *last)
    return call_size(tc_flush_call);
 }
 
+/* Let the uploaders reuse the buffers that this fence covers. */
+static void
+tc_fence_uploaders(struct threaded_context *tc, struct pipe_fence_handle *fence)
+{
+   u_upload_fence(tc->base.stream_uploader, fence);
+   if (tc->base.const_uploader != tc->base.stream_uploader)
+      u_upload_fence(tc->base.const_uploader, fence);
+}
+
 static void
 tc_flush(struct pipe_context *_pipe, struct pipe_fence_handle **fence,
          unsigned flags)
@@ -3506,6 +3679,8 @@ tc_flush(struct pipe_context *_pipe, struct pipe_fence_handle **fence,
                                  tc->options.create_fence(pipe, next->token));
          if (!*fence)
             goto out_of_memory;
+
+         tc_fence_uploaders(tc, *fence);
       }
 
       struct tc_flush_call *p;
@@ -3544,6 +3719,9 @@ out_of_memory:
    pipe->flush(pipe, fence, flags);
    tc_clear_driver_thread(tc);
    tc->flushing = false;
+
+   if (fence && *fence)
+      tc_fence_uploaders(tc, *fence);
 }
 
 struct tc_draw_single {
@@ -3637,7 +3815,9 @@ tc_call_draw_single(struct pipe_context *pipe, void *call, uint64_t *last_ptr)
    if (next != last &&
        next->base.call_id == TC_CALL_draw_single) {
       if (is_next_call_a_mergeable_draw(first, next)) {
-         /* The maximum number of merged draws is given by the batch size. */
+         /* Batches can be bigger than this, in which case the remaining
+          * draws are merged by the next call.
+          */
          struct pipe_draw_start_count_bias multi[TC_SLOTS_PER_BATCH / call_size(tc_draw_single)];
          unsigned num_draws = 2;
          bool index_bias_varies = first->index_bias != next->index_bias;
@@ -3652,7 +3832,8 @@ tc_call_draw_single(struct pipe_context *pipe, void *call, uint64_t *last_ptr)
 
          /* Find how many other draws can be merged. */
          next = get_next_call(next, tc_draw_single);
-         for (; next != last && is_next_call_a_mergeable_draw(first, next);
+         for (; next != last && num_draws < ARRAY_SIZE(multi) &&
+                is_next_call_a_mergeable_draw(first, next);
               next = get_next_call(next, tc_draw_single), num_draws++) {
             /* u_threaded_context stores start/count in min/max_index for single draws. */
             multi[num_draws].start = next->info.min_index;
@@ -3893,7 +4074,7 @@ tc_draw_vbo(struct pipe_context *_pipe, const struct pipe_draw_info *info,
       while (num_draws) {
          struct tc_batch *next = &tc->batch_slots[tc->next];
 
-         int nb_slots_left = TC_SLOTS_PER_BATCH - next->num_total_slots;
+         int nb_slots_left = (int)tc->batch_limit - next->num_total_slots;
          /* If there isn't enough place for one draw, try to fill the next one */
          if (nb_slots_left < slots_for_one_draw)
             nb_slots_left = TC_SLOTS_PER_BATCH;
@@ -3946,7 +4127,7 @@ tc_draw_vbo(struct pipe_context *_pipe, const struct pipe_draw_info *info,
       while (num_draws) {
          struct tc_batch *next = &tc->batch_slots[tc->next];
 
-         int nb_slots_left = TC_SLOTS_PER_BATCH - next->num_total_slots;
+         int nb_slots_left = (int)tc->batch_limit - next->num_total_slots;
          /* If there isn't enough place for one draw, try to fill the next one */
          if (nb_slots_left < slots_for_one_draw)
             nb_slots_left = TC_SLOTS_PER_BATCH;
@@ -4017,7 +4198,9 @@ tc_call_draw_vstate_single(struct pipe_context *pipe, void *call, uint64_t *last
    /* If at least 2 consecutive draw calls can be merged... */
    if (next != last &&
        is_next_call_a_mergeable_draw_vstate(first, next)) {
-      /* The maximum number of merged draws is given by the batch size. */
+      /* Batches can be bigger than this, in which case the remaining draws
+       * are merged by the next call.
+       */
       struct pipe_draw_start_count_bias draws[TC_SLOTS_PER_BATCH /
                                               call_size(tc_draw_vstate_single)];
       unsigned num_draws = 2;
@@ -4027,7 +4210,7 @@ tc_call_draw_vstate_single(struct pipe_context *pipe, void *call, uint64_t *last
 
       /* Find how many other draws can be merged. */
       next = get_next_call(next, tc_draw_vstate_single);
-      for (; next != last &&
+      for (; next != last && num_draws < ARRAY_SIZE(draws) &&
            is_next_call_a_mergeable_draw_vstate(first, next);
            next = get_next_call(next, tc_draw_vstate_single),
            num_draws++)
@@ -4115,7 +4298,7 @@ tc_draw_vertex_state(struct pipe_context *_pipe,
    while (num_draws) {
       struct tc_batch *next = &tc->batch_slots[tc->next];
 
-      int nb_slots_left = TC_SLOTS_PER_BATCH - next->num_total_slots;
+      int nb_slots_left = (int)tc->batch_limit - next->num_total_slots;
       /* If there isn't enough place for one draw, try to fill the next one */
       if (nb_slots_left < slots_for_one_draw)
          nb_slots_left = TC_SLOTS_PER_BATCH;
@@ -4834,6 +5017,7 @@ tc_destroy(struct pipe_context *_pipe)
       for (unsigned i = 0; i < TC_MAX_BATCHES; i++) {
          util_queue_fence_destroy(&tc->batch_slots[i].fence);
          util_dynarray_fini(&tc->batch_slots[i].renderpass_infos);
+         FREE(tc->batch_slots[i].slots);
          assert(!tc->batch_slots[i].token);
       }
    }
@@ -4937,6 +5121,13 @@ threaded_context_create(struct pipe_context *pipe,
    if (!tc->base.stream_uploader || !tc->base.const_uploader)
       goto fail;
 
+   /* Reuse full upload buffers once the fences from tc_flush say they are
+    * idle instead of allocating new ones.
+    */
+   u_upload_enable_ring(tc->base.stream_uploader, 4);
+   if (tc->base.const_uploader != tc->base.stream_uploader)
+      u_upload_enable_ring(tc->base.const_uploader, 4);
+
    tc->use_forced_staging_uploads = true;
 
    /* The queue size is the number of batches "waiting". Batches are removed
@@ -4946,12 +5137,18 @@ threaded_context_create(struct pipe_context *pipe,
    if (!util_queue_init(&tc->queue, "gdrv", TC_MAX_BATCHES - 2, 1, 0, NULL))
       goto fail;
 
+   tc->batch_max_slots = TC_SLOTS_PER_BATCH;
+   tc->batch_limit = TC_SLOTS_PER_BATCH;
+
    for (unsigned i = 0; i < TC_MAX_BATCHES; i++) {
 #if !defined(NDEBUG) && TC_DEBUG >= 1
       tc->batch_slots[i].sentinel = TC_SENTINEL;
 #endif
       tc->batch_slots[i].tc = tc;
       util_queue_fence_init(&tc->batch_slots[i].fence);
+      tc_batch_resize(tc, &tc->batch_slots[i]);
+      if (!tc->batch_slots[i].slots)
+         goto fail;
       tc->batch_slots[i].renderpass_info_idx = -1;
       if (tc->options.parse_renderpass_info) {
          util_dynarray_init(&tc->batch_slots[i].renderpass_infos, NULL);
@@ -242,14 +242,27 @@ struct tc_unflushed_batch_token;
  */
 #define TC_MAX_BATCHES        10
 
-/* The size of one batch. Non-trivial calls (i.e. not setting a CSO pointer)
- * can occupy multiple call slots.
+/* The initial size of one batch. Non-trivial calls (i.e. not setting a CSO
+ * pointer) can occupy multiple call slots. No single call can be larger than
+ * this.
  *
  * The idea is to have batches as small as possible but large enough so that
  * the queuing and mutex overhead is negligible.
  */
 #define TC_SLOTS_PER_BATCH    1536
 
+/* Batches are grown up to this size when the application thread has to wait
+ * for the driver thread because all batches are in use, so that more work
+ * can be queued before the next wait.
+ */
+#define TC_MAX_SLOTS_PER_BATCH (TC_SLOTS_PER_BATCH * 4)
+
+/* The lowest number of slots after which a batch is flushed. Batches are
+ * flushed sooner when the driver thread is idle, so that it can start
+ * executing them sooner.
+ */
+#define TC_MIN_SLOTS_PER_BATCH 256
+
 /* The buffer list queue is much deeper than the batch queue because buffer
  * lists need to stay around until the driver internally flushes its command
  * buffer.
@@ -491,6 +504,8 @@ struct tc_batch {
    unsigned sentinel;
 #endif
    uint16_t num_total_slots;
+   /* the number of slots allocated in "slots" */
+   uint16_t max_slots;
    uint16_t buffer_list_index;
    /* the index of the current renderpass info for recording */
    int16_t renderpass_info_idx;
@@ -505,7 +520,7 @@ struct tc_batch {
    /* whether the first set_framebuffer_state call has been seen by this batch */
    bool first_set_fb;
    struct tc_unflushed_batch_token *token;
-   uint64_t slots[TC_SLOTS_PER_BATCH];
+   uint64_t *slots;
    struct util_dynarray renderpass_infos;
 };
 
@@ -559,6 +574,16 @@ struct threaded_context {
    unsigned num_offloaded_slots;
    unsigned num_direct_slots;
    unsigned num_syncs;
+   unsigned num_batches;
+   /* how many times and for how long the application thread waited for
+    * a free batch
+    */
+   unsigned num_stalls;
+   uint64_t stall_time_ns;
+   /* state calls that were skipped because they bound the current state */
+   unsigned num_elided_calls;
+   /* draws that the driver thread merged into a previous draw */
+   unsigned num_merged_draws;
 
    bool use_forced_staging_uploads;
    bool add_all_gfx_bindings_to_buffer_list;
@@ -608,6 +633,13 @@ struct threaded_context {
 
    unsigned last, next, next_buf_list;
 
+   /* The number of slots after which the current batch is flushed. It's
+    * adjusted at every flush depending on whether the driver thread is idle.
+    */
+   unsigned batch_limit;
+   /* The size that batches are grown to when they are reused. */
+   unsigned batch_max_slots;
+
    /* The list fences that the driver should signal after the next flush.
     * If this is empty, all driver command buffers have been flushed.
     */
@@ -626,6 +658,27 @@ struct threaded_context {
    uint64_t image_buffers_writeable_mask[PIPE_SHADER_TYPES];
    uint32_t sampler_buffers[PIPE_SHADER_TYPES][PIPE_MAX_SHADER_SAMPLER_VIEWS];
 
+   /* The states last bound by the frontend, so that binding the same state
+    * again doesn't add a call, which would prevent draw merging. NULL means
+    * unknown. Sampler views and constant buffers can't be freed and
+    * reallocated at the same address while they are here, because the
+    * driver holds a reference to bound views and buffers.
+    */
+   struct {
+      void *blend;
+      void *rasterizer;
+      void *depth_stencil_alpha;
+      void *compute;
+      void *fs, *vs, *gs, *tcs, *tes;
+      void *vertex_elements;
+   } bound_cso;
+   void *bound_samplers[PIPE_SHADER_TYPES][PIPE_MAX_SAMPLERS];
+   struct pipe_sampler_view *bound_sampler_views[PIPE_SHADER_TYPES][PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   struct {
+      struct pipe_resource *buffer;
+      unsigned offset, size;
+   } bound_const_buffers[PIPE_SHADER_TYPES][PIPE_MAX_CONSTANT_BUFFERS];
+
    struct tc_batch batch_slots[TC_MAX_BATCHES];
    struct tc_buffer_list buffer_lists[TC_MAX_BUFFER_LISTS];
    /* the current framebuffer attachments; [PIPE_MAX_COLOR_BUFS] is the zsbuf */
@@ -55,6 +55,16 @@ struct u_upload_mgr {
    unsigned offset; /* Aligned offset to the upload buffer, pointing
                      * at the first unused byte. */
    int buffer_private_refcount;
+
+   /* Ring mode: full buffers, oldest first, and the fences after which
+    * the GPU is done with them (NULL if not known yet).
+    */
+   unsigned ring_size;
+   unsigned num_ring_buffers;
+   struct {
+      struct pipe_resource *buffer;
+      struct pipe_fence_handle *fence;
+   } ring[U_UPLOAD_MAX_RING_BUFFERS];
 };
 
 
@@ -109,6 +119,8 @@ u_upload_clone(struct pipe_context *pipe, struct u_upload_mgr *upload)
                                                  upload->flags);
    if (!upload->map_persistent && result->map_persistent)
       u_upload_disable_persistent(result);
+   if (upload->ring_size)
+      u_upload_enable_ring(result, upload->ring_size);
 
    return result;
 }
@@ -121,6 +133,12 @@ u_upload_disable_persistent(struct u_upload_mgr *upload)
    upload->map_flags |= PIPE_MAP_FLUSH_EXPLICIT;
 }
 
+void
+u_upload_enable_ring(struct u_upload_mgr *upload, unsigned num_buffers)
+{
+   upload->ring_size = MIN2(num_buffers, U_UPLOAD_MAX_RING_BUFFERS);
+}
+
 static void
 upload_unmap_internal(struct u_upload_mgr *upload, bool destroying)
 {
@@ -166,10 +184,82 @@ u_upload_release_buffer(struct u_upload_mgr *upload)
 }
 
 
+static void
+u_upload_release_ring_buffer(struct u_upload_mgr *upload, unsigned i)
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+
+   pipe_resource_reference(&upload->ring[i].buffer, NULL);
+   screen->fence_reference(screen, &upload->ring[i].fence, NULL);
+
+   upload->num_ring_buffers--;
+   memmove(&upload->ring[i], &upload->ring[i + 1],
+           (upload->num_ring_buffers - i) * sizeof(upload->ring[0]));
+}
+
+
+/* Move the full upload buffer to the ring, dropping the oldest buffer
+ * if the ring is full.
+ */
+static void
+u_upload_retire_buffer(struct u_upload_mgr *upload)
+{
+   struct pipe_resource *buffer = NULL;
+
+   /* Keep our own reference and drop everything else. */
+   pipe_resource_reference(&buffer, upload->buffer);
+   u_upload_release_buffer(upload);
+
+   if (upload->num_ring_buffers == upload->ring_size)
+      u_upload_release_ring_buffer(upload, 0);
+
+   upload->ring[upload->num_ring_buffers].buffer = buffer;
+   upload->ring[upload->num_ring_buffers].fence = NULL;
+   upload->num_ring_buffers++;
+}
+
+
+/* Take the oldest buffer out of the ring if it's idle and large enough. */
+static struct pipe_resource *
+u_upload_reuse_buffer(struct u_upload_mgr *upload, unsigned min_size)
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+   struct pipe_resource *buffer = NULL;
+
+   if (!upload->num_ring_buffers ||
+       !upload->ring[0].fence ||
+       upload->ring[0].buffer->width0 < min_size ||
+       !screen->fence_finish(screen, NULL, upload->ring[0].fence, 0))
+      return NULL;
+
+   pipe_resource_reference(&buffer, upload->ring[0].buffer);
+   u_upload_release_ring_buffer(upload, 0);
+   return buffer;
+}
+
+
+void
+u_upload_fence(struct u_upload_mgr *upload, struct pipe_fence_handle *fence)
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+
+   for (unsigned i = 0; i < upload->num_ring_buffers; i++) {
+      /* If the uploader holds the only reference, nothing can use the
+       * buffer after this point, so this fence covers all its uses.
+       */
+      if (!upload->ring[i].fence &&
+          p_atomic_read(&upload->ring[i].buffer->reference.count) == 1)
+         screen->fence_reference(screen, &upload->ring[i].fence, fence);
+   }
+}
+
+
 void
 u_upload_destroy(struct u_upload_mgr *upload)
 {
    u_upload_release_buffer(upload);
+   while (upload->num_ring_buffers)
+      u_upload_release_ring_buffer(upload, upload->num_ring_buffers - 1);
    FREE(upload);
 }
 
@@ -183,7 +273,18 @@ u_upload_alloc_buffer(struct u_upload_mgr *upload, unsigned min_size)
 
    /* Release the old buffer, if present:
     */
-   u_upload_release_buffer(upload);
+   if (upload->ring_size && upload->buffer) {
+      u_upload_retire_buffer(upload);
+
+      /* Reuse an idle buffer if possible. */
+      upload->buffer = u_upload_reuse_buffer(upload, min_size);
+      if (upload->buffer) {
+         size = upload->buffer->width0;
+         goto map;
+      }
+   } else {
+      u_upload_release_buffer(upload);
+   }
 
    /* Allocate a new one:
     */
@@ -209,6 +310,7 @@ u_upload_alloc_buffer(struct u_upload_mgr *upload, unsigned min_size)
    if (upload->buffer == NULL)
       return 0;
 
+map:
    /* Since atomic operations are very very slow when 2 threads are not
     * sharing the same L3 cache (which happens on AMD Zen), eliminate all
     * atomics in u_upload_alloc as follows:
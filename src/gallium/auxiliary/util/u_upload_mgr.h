@@ -37,6 +37,10 @@
 
 struct pipe_context;
 struct pipe_resource;
+struct pipe_fence_handle;
+
+/* The maximum number of full buffers kept for reuse in ring mode. */
+#define U_UPLOAD_MAX_RING_BUFFERS 8
 
 #ifdef __cplusplus
 extern "C" {
@@ -73,6 +77,23 @@ u_upload_clone(struct pipe_context *pipe, struct u_upload_mgr *upload);
 void
 u_upload_disable_persistent(struct u_upload_mgr *upload);
 
+/**
+ * Keep up to num_buffers full upload buffers around and reuse them once
+ * the GPU is done with them, instead of allocating a new buffer every time
+ * the current one is full. The owner of the uploader must report its
+ * fences with u_upload_fence for buffers to be reused.
+ */
+void
+u_upload_enable_ring(struct u_upload_mgr *upload, unsigned num_buffers);
+
+/**
+ * Report a fence that signals when all work submitted so far is done.
+ * Full buffers that are no longer referenced by anything but the uploader
+ * can be reused once the fence has signalled.
+ */
+void
+u_upload_fence(struct u_upload_mgr *upload, struct pipe_fence_handle *fence);
+
 /**
  * Destroy the upload manager.
  */
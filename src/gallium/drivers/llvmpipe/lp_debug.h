@@ -65,6 +65,8 @@
 #define PERF_NO_ALPHATEST   0x80  	/* disable alpha testing */
 #define PERF_NO_RAST_LINEAR 0x100  	/* disable linear rast */
 #define PERF_NO_SHADE       0x200  	/* disable fragment shaders */
+#define PERF_PAD_STRIDE     0x400  	/* avoid cache set aliasing of rows */
+#define PERF_HUGE_PAGES     0x800  	/* back large textures with huge pages */
 
 
 extern int LP_PERF;
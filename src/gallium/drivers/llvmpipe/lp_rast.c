@@ -114,6 +114,9 @@ lp_rast_tile_begin(struct lp_rasterizer_task *task,
    task->thread_data.vis_counter = 0;
    task->thread_data.ps_invocations = 0;
 
+   /* Nothing is known about the depth values loaded from memory. */
+   task->depth_range_valid = false;
+
    for (unsigned i = 0; i < scene->fb.nr_cbufs; i++) {
       if (scene->fb.cbufs[i]) {
          task->color_tiles[i] = scene->cbufs[i].map +
@@ -177,6 +180,66 @@ lp_rast_clear_color(struct lp_rasterizer_task *task,
 }
 
 
+/**
+ * Update the depth range of the current tile after a z/stencil clear.
+ * A clear of all depth bits makes the range known, a partial clear of
+ * the depth bits makes it unknown and a stencil-only clear leaves it
+ * alone.
+ */
+static void
+lp_rast_clear_depth_range(struct lp_rasterizer_task *task,
+                          uint64_t value, uint64_t mask)
+{
+   const enum pipe_format format = task->scene->fb.zsbuf->format;
+   const struct util_format_description *desc =
+      util_format_description(format);
+
+   if (!util_format_has_depth(desc))
+      return;
+
+   const uint64_t zmask = util_pack64_mask_z(format, ~0);
+
+   if ((mask & zmask) != zmask) {
+      if (mask & zmask)
+         task->depth_range_valid = false;
+      return;
+   }
+
+   const uint16_t value16 = (uint16_t) value;
+   const uint32_t value32 = (uint32_t) value;
+   float depth;
+
+   switch (util_format_get_blocksize(format)) {
+   case 2:
+      util_format_unpack_z_float(format, &depth, &value16, 1);
+      break;
+   case 4:
+      util_format_unpack_z_float(format, &depth, &value32, 1);
+      break;
+   case 8:
+      util_format_unpack_z_float(format, &depth, &value, 1);
+      break;
+   default:
+      task->depth_range_valid = false;
+      return;
+   }
+
+   /* Round up so that anything above the bound is still above the stored
+    * value once converted to the depth format.  For unorm formats this
+    * takes two steps: one for the rounding of the unpacked clear value to
+    * float, and one for the float-to-unorm rounding of the fragment depth.
+    * A single step is not enough to keep the culling safe.
+    */
+   const struct util_format_channel_description *chan =
+      &desc->channel[desc->swizzle[0]];
+   if (chan->normalized)
+      depth += 2.0f / (float)((UINT64_C(1) << chan->size) - 1);
+
+   task->depth_range_max = depth;
+   task->depth_range_valid = true;
+}
+
+
 /**
  * Clear the rasterizer's current z/stencil tile.
  * This is a bin command called during bin processing.
@@ -285,6 +348,9 @@ lp_rast_clear_zstencil(struct lp_rasterizer_task *task,
             dst_layer += scene->zsbuf.layer_stride;
          }
       }
+
+      lp_rast_clear_depth_range(task, arg.clear_zstencil.value,
+                                arg.clear_zstencil.mask);
    }
 }
 
@@ -317,6 +383,11 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
 
    const struct lp_fragment_shader_variant *variant = state->variant;
 
+   if (lp_rast_depth_range_reject(task, inputs, tile_x, tile_y, TILE_SIZE))
+      return;
+
+   lp_rast_depth_range_update(task);
+
    /* render the whole 64x64 tile in 4x4 chunks */
    for (unsigned y = 0; y < task->height; y += 4){
       for (unsigned x = 0; x < task->width; x += 4) {
@@ -428,6 +499,11 @@ lp_rast_shade_quads_mask_sample(struct lp_rasterizer_task *task,
    assert((x % 4) == 0);
    assert((y % 4) == 0);
 
+   if (lp_rast_depth_range_reject(task, inputs, x, y, 4))
+      return;
+
+   lp_rast_depth_range_update(task);
+
    /* color buffer */
    uint8_t *color[PIPE_MAX_COLOR_BUFS];
    unsigned stride[PIPE_MAX_COLOR_BUFS];
@@ -28,6 +28,8 @@
 #ifndef LP_RAST_PRIV_H
 #define LP_RAST_PRIV_H
 
+#include <float.h>
+
 #include "util/format/u_format.h"
 #include "util/u_thread.h"
 #include "gallivm/lp_bld_debug.h"
@@ -91,6 +93,16 @@ struct lp_rasterizer_task
    uint8_t *color_tiles[PIPE_MAX_COLOR_BUFS];
    uint8_t *depth_tile;
 
+   /**
+    * Upper bound of the values in the current depth tile (across all
+    * layers and samples).  For unorm formats it is rounded up by two steps
+    * of the depth format, see lp_rast_clear_depth_range().  Only meaningful while depth_range_valid is set, which is
+    * the case after a full depth clear until a shade command that may
+    * raise the stored depth touches the tile.
+    */
+   float depth_range_max;
+   bool depth_range_valid;
+
    /** "back" pointer */
    struct lp_rasterizer *rast;
 
@@ -215,6 +227,61 @@ lp_rast_get_depth_block_pointer(struct lp_rasterizer_task *task,
 }
 
 
+/**
+ * Return true if all fragments the shader inputs can produce in the
+ * size x size pixel block at x, y are known to fail the depth test
+ * against the current tile's depth range, in which case the block
+ * doesn't need to be shaded at all.
+ */
+static inline bool
+lp_rast_depth_range_reject(const struct lp_rasterizer_task *task,
+                           const struct lp_rast_shader_inputs *inputs,
+                           int x, int y, unsigned size)
+{
+   const struct lp_rast_state *state = task->state;
+
+   if (!task->depth_range_valid || !state->variant->depth_range_cull)
+      return false;
+
+   /* Position is the first input, depth is interpolated linearly from
+    * its z component, so the minimum lies on a corner of the block.
+    */
+   const float z0 = GET_A0(inputs)[0][2];
+   const float dzdx = GET_DADX(inputs)[0][2];
+   const float dzdy = GET_DADY(inputs)[0][2];
+   const float x0 = (float)x, x1 = (float)(x + size);
+   const float y0 = (float)y, y1 = (float)(y + size);
+   float zmin = z0 + MIN2(dzdx * x0, dzdx * x1) + MIN2(dzdy * y0, dzdy * y1);
+
+   /* Leave room for the rounding of the interpolation in the shader. */
+   zmin -= 16.0f * FLT_EPSILON *
+           (fabsf(z0) + fabsf(dzdx) * x1 + fabsf(dzdy) * y1);
+
+   /* Depth clamping can only pull the values down to the upper bound. */
+   const struct lp_fragment_shader_variant_key *key = &state->variant->key;
+   if (key->restrict_depth_values)
+      zmin = MIN2(zmin, 1.0f);
+   if (key->depth_clamp)
+      zmin = MIN2(zmin,
+                  state->jit_context.viewports[inputs->viewport_index].max_depth);
+
+   return zmin > task->depth_range_max;
+}
+
+
+/**
+ * Called before shading with the current state.  Drawing with a variant
+ * that may write depth values larger than the stored ones invalidates
+ * the tile's depth range.
+ */
+static inline void
+lp_rast_depth_range_update(struct lp_rasterizer_task *task)
+{
+   if (!task->state->variant->depth_range_keep)
+      task->depth_range_valid = false;
+}
+
+
 /**
  * Shade all pixels in a 4x4 block.  The fragment code omits the
  * triangle in/out tests.
@@ -235,6 +302,11 @@ lp_rast_shade_quads_all(struct lp_rasterizer_task *task,
    unsigned depth_stride = 0;
    unsigned depth_sample_stride = 0;
 
+   if (lp_rast_depth_range_reject(task, inputs, x, y, 4))
+      return;
+
+   lp_rast_depth_range_update(task);
+
    /* color buffer */
    for (unsigned i = 0; i < scene->fb.nr_cbufs; i++) {
       if (scene->fb.cbufs[i]) {
@@ -102,6 +102,9 @@ TAG(do_block_16)(struct lp_rasterizer_task *task,
    unsigned outmask = 0;      /* outside one or more trivial reject planes */
    unsigned partmask = 0;     /* outside one or more trivial accept planes */
 
+   if (lp_rast_depth_range_reject(task, &tri->inputs, x, y, 16))
+      return;
+
    for (unsigned j = 0; j < NR_PLANES; j++) {
 #ifdef RASTER_64
       int32_t dcdx = -plane[j].dcdx >> FIXED_ORDER;
@@ -210,6 +213,9 @@ TAG(lp_rast_triangle)(struct lp_rasterizer_task *task,
       return;
    }
 
+   if (lp_rast_depth_range_reject(task, &tri->inputs, x, y, TILE_SIZE))
+      return;
+
    outmask = 0;                 /* outside one or more trivial reject planes */
    partmask = 0;                /* outside one or more trivial accept planes */
 
@@ -104,6 +104,12 @@ lp_scene_destroy(struct lp_scene *scene)
    mtx_destroy(&scene->mutex);
    free(scene->tiles);
    assert(scene->data.head == &scene->data.first);
+
+   while (scene->data.free) {
+      struct data_block *block = scene->data.free;
+      scene->data.free = block->next;
+      FREE(block);
+   }
    slab_free_st(&scene->setup->scene_slab, scene);
 }
 
@@ -297,7 +303,8 @@ lp_scene_end_rasterization(struct lp_scene *scene)
       }
    }
 
-   /* Free all scene data blocks:
+   /* Free all scene data blocks, keeping a few of them around for the next
+    * use of this scene:
     */
    {
       struct data_block_list *list = &scene->data;
@@ -305,8 +312,16 @@ lp_scene_end_rasterization(struct lp_scene *scene)
 
       for (block = list->head; block; block = tmp) {
          tmp = block->next;
-         if (block != &list->first)
+         if (block == &list->first)
+            continue;
+
+         if (list->num_free < LP_SCENE_MAX_FREE_DATA_BLOCKS) {
+            block->next = list->free;
+            list->free = block;
+            list->num_free++;
+         } else {
             FREE(block);
+         }
       }
 
       list->head = &list->first;
@@ -356,9 +371,15 @@ lp_scene_new_data_block(struct lp_scene *scene)
       scene->alloc_failed = true;
       return NULL;
    } else {
-      struct data_block *block = MALLOC_STRUCT(data_block);
-      if (!block)
-         return NULL;
+      struct data_block *block = scene->data.free;
+      if (block) {
+         scene->data.free = block->next;
+         scene->data.num_free--;
+      } else {
+         block = MALLOC_STRUCT(data_block);
+         if (!block)
+            return NULL;
+      }
 
       scene->scene_size += sizeof *block;
 
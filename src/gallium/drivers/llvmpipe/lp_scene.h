@@ -63,6 +63,9 @@ struct lp_rast_state;
  */
 #define LP_SCENE_MAX_SIZE (36*1024*1024)
 
+/* Max number of data blocks a scene keeps around for reuse (1MB) */
+#define LP_SCENE_MAX_FREE_DATA_BLOCKS 16
+
 /* The maximum amount of texture storage referenced by a scene is
  * clamped to this size:
  */
@@ -114,6 +117,12 @@ struct cmd_bin {
 struct data_block_list {
    struct data_block first;
    struct data_block *head;
+
+   /* Blocks released by previous uses of this scene, reused before
+    * allocating new ones.
+    */
+   struct data_block *free;
+   unsigned num_free;
 };
 
 struct resource_ref;
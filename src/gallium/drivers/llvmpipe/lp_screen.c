@@ -96,6 +96,8 @@ static const struct debug_named_value lp_perf_flags[] = {
    { "no_alphatest",   PERF_NO_ALPHATEST, NULL },
    { "no_rast_linear", PERF_NO_RAST_LINEAR, NULL },
    { "no_shade",       PERF_NO_SHADE, NULL },
+   { "pad_stride",     PERF_PAD_STRIDE, NULL },
+   { "huge_pages",     PERF_HUGE_PAGES, NULL },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -1140,22 +1140,24 @@ static void
 lp_cs_get_ir_cache_key(struct lp_compute_shader_variant *variant,
                        unsigned char ir_sha1_cache_key[20])
 {
-   struct blob blob = { 0 };
-   unsigned ir_size;
-   void *ir_binary;
+   struct lp_compute_shader *shader = variant->shader;
 
-   blob_init(&blob);
-   nir_serialize(&blob, variant->shader->base.ir.nir, true);
-   ir_binary = blob.data;
-   ir_size = blob.size;
+   /* The NIR hash doesn't depend on the variant key, compute it once. */
+   if (!shader->has_ir_sha1) {
+      struct blob blob = { 0 };
+
+      blob_init(&blob);
+      nir_serialize(&blob, shader->base.ir.nir, true);
+      _mesa_sha1_compute(blob.data, blob.size, shader->ir_sha1);
+      blob_finish(&blob);
+      shader->has_ir_sha1 = true;
+   }
 
    struct mesa_sha1 ctx;
    _mesa_sha1_init(&ctx);
-   _mesa_sha1_update(&ctx, &variant->key, variant->shader->variant_key_size);
-   _mesa_sha1_update(&ctx, ir_binary, ir_size);
+   _mesa_sha1_update(&ctx, &variant->key, shader->variant_key_size);
+   _mesa_sha1_update(&ctx, shader->ir_sha1, sizeof(shader->ir_sha1));
    _mesa_sha1_final(&ctx, ir_sha1_cache_key);
-
-   blob_finish(&blob);
 }
 
 
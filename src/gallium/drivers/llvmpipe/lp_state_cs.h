@@ -124,6 +124,10 @@ struct lp_compute_shader {
    unsigned variants_cached;
    bool zero_initialize_shared_memory;
 
+   /** SHA1 of the serialized NIR, for shader cache keys */
+   unsigned char ir_sha1[20];
+   bool has_ir_sha1;
+
    int max_global_buffers;
    struct pipe_resource **global_buffers;
 };
@@ -3704,22 +3704,28 @@ static void
 lp_fs_get_ir_cache_key(struct lp_fragment_shader_variant *variant,
                        unsigned char ir_sha1_cache_key[20])
 {
-   struct blob blob = { 0 };
-   unsigned ir_size;
-   void *ir_binary;
+   struct lp_fragment_shader *shader = variant->shader;
 
-   blob_init(&blob);
-   nir_serialize(&blob, variant->shader->base.ir.nir, true);
-   ir_binary = blob.data;
-   ir_size = blob.size;
+   /* Serializing and hashing the NIR is the expensive part of computing the
+    * cache key, and it doesn't depend on the variant key, so only do it for
+    * the first variant of the shader.  This also keeps the key independent
+    * of the lowering that variant compilation applies to the NIR.
+    */
+   if (!shader->has_ir_sha1) {
+      struct blob blob = { 0 };
+
+      blob_init(&blob);
+      nir_serialize(&blob, shader->base.ir.nir, true);
+      _mesa_sha1_compute(blob.data, blob.size, shader->ir_sha1);
+      blob_finish(&blob);
+      shader->has_ir_sha1 = true;
+   }
 
    struct mesa_sha1 ctx;
    _mesa_sha1_init(&ctx);
-   _mesa_sha1_update(&ctx, &variant->key, variant->shader->variant_key_size);
-   _mesa_sha1_update(&ctx, ir_binary, ir_size);
+   _mesa_sha1_update(&ctx, &variant->key, shader->variant_key_size);
+   _mesa_sha1_update(&ctx, shader->ir_sha1, sizeof(shader->ir_sha1));
    _mesa_sha1_final(&ctx, ir_sha1_cache_key);
-
-   blob_finish(&blob);
 }
 
 
@@ -3818,6 +3824,30 @@ generate_variant(struct llvmpipe_context *lp,
          shader->info.cbuf[0][3].file != TGSI_FILE_NULL
          ? true : false;
 
+   /* A LESS/LEQUAL depth test only ever stores smaller values, so the
+    * upper bound of a tile's depth stays valid.  Blocks entirely above
+    * it fail the test, which can only be skipped if failing has no other
+    * effect than not writing anything.
+    */
+   const bool depth_less =
+         key->depth.enabled &&
+         (key->depth.func == PIPE_FUNC_LESS ||
+          key->depth.func == PIPE_FUNC_LEQUAL);
+
+   variant->depth_range_keep =
+         !key->depth.enabled ||
+         !key->depth.writemask ||
+         depth_less;
+
+   variant->depth_range_cull =
+         depth_less &&
+         !key->stencil[0].enabled &&
+         !key->alpha.enabled &&
+         !key->blend.alpha_to_coverage &&
+         !shader->info.base.uses_kill &&
+         !shader->info.base.writes_z &&
+         !shader->info.base.writes_memory;
+
    /* We only care about opaque blits for now */
    if (variant->opaque &&
        (shader->kind == LP_FS_KIND_BLIT_RGBA ||
@@ -151,6 +151,13 @@ struct lp_fragment_shader_variant
 
    unsigned opaque:1;
    unsigned blit:1;
+
+   /*
+    * Whether blocks behind the tile's known depth range can be skipped,
+    * and whether shading with this variant keeps that range valid.
+    */
+   unsigned depth_range_cull:1;
+   unsigned depth_range_keep:1;
    unsigned linear_input_mask:16;
    struct pipe_reference reference;
 
@@ -218,6 +225,10 @@ struct lp_fragment_shader
    unsigned variants_created;
    unsigned variants_cached;
 
+   /** SHA1 of the serialized NIR, for shader cache keys */
+   unsigned char ir_sha1[20];
+   bool has_ir_sha1;
+
    /** Fragment shader input interpolation info */
    struct lp_shader_input inputs[PIPE_MAX_SHADER_INPUTS];
 };
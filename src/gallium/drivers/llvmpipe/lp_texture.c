@@ -50,6 +50,7 @@
 #include "lp_setup.h"
 #include "lp_state.h"
 #include "lp_rast.h"
+#include "lp_debug.h"
 
 #include "frontend/sw_winsys.h"
 #include "git_sha1.h"
@@ -58,6 +59,10 @@
 #include "drm-uapi/drm_fourcc.h"
 #endif
 
+#if DETECT_OS_LINUX
+#include <sys/mman.h>
+#endif
+
 
 #ifdef DEBUG
 static struct llvmpipe_resource resource_list;
@@ -65,6 +70,35 @@ static simple_mtx_t resource_list_mutex = SIMPLE_MTX_INITIALIZER;
 #endif
 static unsigned id_counter = 0;
 
+/* Row strides that are a multiple of this are padded with PERF_PAD_STRIDE */
+#define LP_PAD_STRIDE_PERIOD 1024
+
+/* Allocations at least this large use huge pages with PERF_HUGE_PAGES */
+#define LP_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+
+/**
+ * Allocate resource storage.  With PERF_HUGE_PAGES, large allocations are
+ * aligned to and marked for transparent huge pages, which cuts the TLB
+ * misses and page faults of rendering to big targets.  Callers clear the
+ * storage right away, which also faults the pages in up front.
+ */
+static void *
+llvmpipe_alloc_resource_data(size_t size, size_t alignment)
+{
+#ifdef MADV_HUGEPAGE
+   if ((LP_PERF & PERF_HUGE_PAGES) && size >= LP_HUGE_PAGE_SIZE) {
+      void *data = align_malloc(size, LP_HUGE_PAGE_SIZE);
+      if (data)
+         (void) madvise(data, ROUND_DOWN_TO(size, LP_HUGE_PAGE_SIZE),
+                        MADV_HUGEPAGE);
+      return data;
+   }
+#endif
+
+   return align_malloc(size, alignment);
+}
+
 
 /**
  * Conventional allocation path for non-display textures:
@@ -140,6 +174,20 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
          lpr->row_stride[level] = align(nblocksx * block_size,
                                         util_get_cpu_caps()->cacheline);
 
+      /* Strides which are a multiple of a large power of two make the rows
+       * of a vertical texel footprint (a 2x2 quad, a 4x4 raster block)
+       * land in the same few cache sets, so sampling and render target
+       * access thrash the L1 even though the footprint is tiny.  Pad such
+       * strides by one cache line.  The layout stays linear, so sampling
+       * code, the rasterizer and transfers don't need to know about it.
+       */
+      if ((LP_PERF & PERF_PAD_STRIDE) &&
+          !util_format_is_compressed(pt->format) &&
+          !llvmpipe_resource_is_1d(&lpr->base) &&
+          !(pt->bind & (PIPE_BIND_SHARED | PIPE_BIND_SCANOUT)) &&
+          lpr->row_stride[level] % LP_PAD_STRIDE_PERIOD == 0)
+         lpr->row_stride[level] += util_get_cpu_caps()->cacheline;
+
       lpr->img_stride[level] = (uint64_t)lpr->row_stride[level] * nblocksy;
 
       /* Number of 3D image slices, cube faces or texture array layers */
@@ -176,7 +224,7 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
       if (total_size > LP_MAX_TEXTURE_SIZE)
          goto fail;
 
-      lpr->tex_data = align_malloc(total_size, mip_align);
+      lpr->tex_data = llvmpipe_alloc_resource_data(total_size, mip_align);
       if (!lpr->tex_data) {
          return false;
       } else {
@@ -293,7 +341,8 @@ llvmpipe_resource_create_all(struct pipe_screen *_screen,
          if (templat->flags & PIPE_RESOURCE_FLAG_MAP_PERSISTENT)
             os_get_page_size(&alignment);
 
-         lpr->data = align_malloc(lpr->size_required, alignment);
+         lpr->data = llvmpipe_alloc_resource_data(lpr->size_required,
+                                                  alignment);
 
          if (!lpr->data)
             goto fail;
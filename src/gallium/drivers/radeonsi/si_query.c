@@ -157,6 +157,21 @@ static bool si_query_sw_begin(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_TC_NUM_SYNCS:
       query->begin_result = sctx->tc ? sctx->tc->num_syncs : 0;
       break;
+   case SI_QUERY_TC_NUM_BATCHES:
+      query->begin_result = sctx->tc ? sctx->tc->num_batches : 0;
+      break;
+   case SI_QUERY_TC_NUM_STALLS:
+      query->begin_result = sctx->tc ? sctx->tc->num_stalls : 0;
+      break;
+   case SI_QUERY_TC_STALL_TIME:
+      query->begin_result = sctx->tc ? sctx->tc->stall_time_ns : 0;
+      break;
+   case SI_QUERY_TC_NUM_ELIDED_CALLS:
+      query->begin_result = sctx->tc ? sctx->tc->num_elided_calls : 0;
+      break;
+   case SI_QUERY_TC_NUM_MERGED_DRAWS:
+      query->begin_result = sctx->tc ? sctx->tc->num_merged_draws : 0;
+      break;
    case SI_QUERY_REQUESTED_VRAM:
    case SI_QUERY_REQUESTED_GTT:
    case SI_QUERY_MAPPED_VRAM:
@@ -171,6 +186,7 @@ static bool si_query_sw_begin(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_CURRENT_GPU_MCLK:
    case SI_QUERY_BACK_BUFFER_PS_DRAW_RATIO:
    case SI_QUERY_NUM_MAPPED_BUFFERS:
+   case SI_QUERY_TC_BATCH_LIMIT:
       query->begin_result = 0;
       break;
    case SI_QUERY_BUFFER_WAIT_TIME:
@@ -316,6 +332,24 @@ static bool si_query_sw_end(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_TC_NUM_SYNCS:
       query->end_result = sctx->tc ? sctx->tc->num_syncs : 0;
       break;
+   case SI_QUERY_TC_NUM_BATCHES:
+      query->end_result = sctx->tc ? sctx->tc->num_batches : 0;
+      break;
+   case SI_QUERY_TC_NUM_STALLS:
+      query->end_result = sctx->tc ? sctx->tc->num_stalls : 0;
+      break;
+   case SI_QUERY_TC_STALL_TIME:
+      query->end_result = sctx->tc ? sctx->tc->stall_time_ns : 0;
+      break;
+   case SI_QUERY_TC_NUM_ELIDED_CALLS:
+      query->end_result = sctx->tc ? sctx->tc->num_elided_calls : 0;
+      break;
+   case SI_QUERY_TC_NUM_MERGED_DRAWS:
+      query->end_result = sctx->tc ? sctx->tc->num_merged_draws : 0;
+      break;
+   case SI_QUERY_TC_BATCH_LIMIT:
+      query->end_result = sctx->tc ? sctx->tc->batch_limit : 0;
+      break;
    case SI_QUERY_REQUESTED_VRAM:
    case SI_QUERY_REQUESTED_GTT:
    case SI_QUERY_MAPPED_VRAM:
@@ -466,6 +500,7 @@ static bool si_query_sw_get_result(struct si_context *sctx, struct si_query *squ
 
    switch (query->b.type) {
    case SI_QUERY_BUFFER_WAIT_TIME:
+   case SI_QUERY_TC_STALL_TIME:
    case SI_QUERY_GPU_TEMPERATURE:
       result->u64 /= 1000;
       break;
@@ -1733,6 +1768,12 @@ static struct pipe_driver_query_info si_driver_query_list[] = {
    X("tc-offloaded-slots", TC_OFFLOADED_SLOTS, UINT64, AVERAGE),
    X("tc-direct-slots", TC_DIRECT_SLOTS, UINT64, AVERAGE),
    X("tc-num-syncs", TC_NUM_SYNCS, UINT64, AVERAGE),
+   X("tc-num-batches", TC_NUM_BATCHES, UINT64, AVERAGE),
+   X("tc-num-stalls", TC_NUM_STALLS, UINT64, AVERAGE),
+   X("tc-stall-time", TC_STALL_TIME, MICROSECONDS, CUMULATIVE),
+   X("tc-batch-limit", TC_BATCH_LIMIT, UINT64, AVERAGE),
+   X("tc-num-elided-calls", TC_NUM_ELIDED_CALLS, UINT64, AVERAGE),
+   X("tc-num-merged-draws", TC_NUM_MERGED_DRAWS, UINT64, AVERAGE),
    X("CS-thread-busy", CS_THREAD_BUSY, UINT64, AVERAGE),
    X("gallium-thread-busy", GALLIUM_THREAD_BUSY, UINT64, AVERAGE),
    X("requested-VRAM", REQUESTED_VRAM, BYTES, AVERAGE),
@@ -1860,6 +1901,9 @@ static int si_get_driver_query_info(struct pipe_screen *screen, unsigned index,
    case SI_QUERY_GPU_TEMPERATURE:
       info->max_value.u64 = 125;
       break;
+   case SI_QUERY_TC_BATCH_LIMIT:
+      info->max_value.u64 = TC_MAX_SLOTS_PER_BATCH;
+      break;
    case SI_QUERY_VRAM_VIS_USAGE:
       info->max_value.u64 = (uint64_t)sscreen->info.vram_vis_size_kb * 1024;
       break;
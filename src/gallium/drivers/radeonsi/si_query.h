@@ -42,6 +42,12 @@ enum
    SI_QUERY_TC_OFFLOADED_SLOTS,
    SI_QUERY_TC_DIRECT_SLOTS,
    SI_QUERY_TC_NUM_SYNCS,
+   SI_QUERY_TC_NUM_BATCHES,
+   SI_QUERY_TC_NUM_STALLS,
+   SI_QUERY_TC_STALL_TIME,
+   SI_QUERY_TC_BATCH_LIMIT,
+   SI_QUERY_TC_NUM_ELIDED_CALLS,
+   SI_QUERY_TC_NUM_MERGED_DRAWS,
    SI_QUERY_CS_THREAD_BUSY,
    SI_QUERY_GALLIUM_THREAD_BUSY,
    SI_QUERY_REQUESTED_VRAM,
@@ -2662,7 +2662,11 @@ current_not_ready:
    /* This must be done before the mutex is locked, because async GS
     * compilation calls this function too, and therefore must enter
     * the mutex first.
+    *
+    * The selector is needed for this draw, so don't let it wait behind
+    * other selectors that are still being compiled ahead of time.
     */
+   util_queue_promote_job(&sscreen->shader_compiler_queue, &sel->ready);
    util_queue_fence_wait(&sel->ready);
 
    simple_mtx_lock(&sel->mutex);
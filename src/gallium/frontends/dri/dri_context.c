@@ -199,6 +199,8 @@ dri_create_context(struct dri_screen *screen,
       ctx->hud = hud_create(ctx->st->cso_context,
                             share_ctx ? share_ctx->hud : NULL,
                             ctx->st, st_context_invalidate_state);
+      if (ctx->hud)
+         hud_add_atom_timing(ctx->hud, &ctx->st->atom_timing);
    }
 
    /* order of precedence (least to most):
@@ -262,6 +264,7 @@ dri_destroy_context(struct dri_context *ctx)
    _mesa_glthread_finish(ctx->st->ctx);
 
    if (ctx->hud) {
+      hud_remove_atom_timing(ctx->hud, &ctx->st->atom_timing);
       hud_destroy(ctx->hud, ctx->st->cso_context);
    }
 
@@ -116,6 +116,20 @@ enum st_manager_param {
 struct pipe_resource;
 struct util_queue_monitoring;
 
+/**
+ * CPU time spent by st_context in each state atom, for the HUD.
+ *
+ * The counters are only updated while "enabled" is set. They are never
+ * reset, so consumers have to use the difference between two samples.
+ */
+struct st_atom_timing
+{
+   bool enabled;
+   unsigned num_atoms;
+   const char *const *names;
+   uint64_t *time_ns;
+};
+
 /**
  * Used in pipe_frontend_screen::get_egl_image.
  */
@@ -29,6 +29,7 @@
 #include "util/format/u_format.h"
 #include "util/half_float.h"
 #include "util/u_cpu_detect.h"
+#include "util/os_time.h"
 
 /* don't use this for serious use */
 static double rand_double()
@@ -47,6 +48,102 @@ static double rand_double()
 
 char cpu_caps_override_env[128];
 
+/* Measure vertex conversion throughput for a typical u_vbuf workload:
+ * position, normal and color, either interleaved in one buffer or each in
+ * its own tightly packed buffer.
+ */
+static bool
+run_benchmark(struct translate *(*create_fn)(const struct translate_key *key),
+              const char *name)
+{
+   static const struct {
+      enum pipe_format input, output;
+      unsigned size;
+   } attribs[] = {
+      {PIPE_FORMAT_R16G16B16_SNORM, PIPE_FORMAT_R32G32B32_FLOAT, 6},
+      {PIPE_FORMAT_R8G8B8_SNORM, PIPE_FORMAT_R32G32B32_FLOAT, 3},
+      {PIPE_FORMAT_R8G8B8A8_UNORM, PIPE_FORMAT_R32G32B32A32_FLOAT, 4},
+   };
+   const unsigned num_verts = 65536, num_runs = 50;
+   const unsigned in_stride = 16, out_stride = 40;
+   unsigned char *input = align_malloc(num_verts * in_stride, 64);
+   unsigned char *output = align_malloc(num_verts * out_stride, 64);
+   unsigned char *reference = align_malloc(num_verts * out_stride, 64);
+   unsigned *elts = align_malloc(num_verts * sizeof(*elts), 64);
+   bool all_match = true;
+   unsigned i;
+
+   for (i = 0; i < num_verts * in_stride; i++)
+      input[i] = rand();
+   for (i = 0; i < num_verts; i++)
+      elts[i] = i;
+
+   for (unsigned packed = 0; packed < 2; packed++) {
+      struct translate_key key = {0};
+      unsigned in_offset = 0, out_offset = 0;
+
+      key.output_stride = out_stride;
+      key.nr_elements = ARRAY_SIZE(attribs);
+      for (i = 0; i < ARRAY_SIZE(attribs); i++) {
+         key.element[i].type = TRANSLATE_ELEMENT_NORMAL;
+         key.element[i].input_format = attribs[i].input;
+         key.element[i].output_format = attribs[i].output;
+         key.element[i].input_buffer = packed ? i : 0;
+         key.element[i].input_offset = packed ? 0 : in_offset;
+         key.element[i].output_offset = out_offset;
+         in_offset += attribs[i].size;
+         out_offset += util_format_get_blocksize(attribs[i].output);
+      }
+
+      struct translate *translate = create_fn(&key);
+      if (!translate)
+         continue;
+
+      for (i = 0; i < ARRAY_SIZE(attribs); i++) {
+         if (packed) {
+            translate->set_buffer(translate, i, input + i * num_verts * 6,
+                                  attribs[i].size, num_verts - 1);
+         } else {
+            translate->set_buffer(translate, 0, input, in_stride,
+                                  num_verts - 1);
+         }
+      }
+
+      /* Indexed and non-indexed runs must produce the same vertices. */
+      memset(reference, 0, num_verts * out_stride);
+      memset(output, 0, num_verts * out_stride);
+      translate->run(translate, 0, num_verts, 0, 0, reference);
+      translate->run_elts(translate, elts, num_verts, 0, 0, output);
+      bool match = !memcmp(reference, output, num_verts * out_stride);
+      all_match &= match;
+
+      int64_t start = os_time_get_nano();
+      for (i = 0; i < num_runs; i++)
+         translate->run(translate, 0, num_verts, 0, 0, output);
+      int64_t linear = os_time_get_nano() - start;
+
+      start = os_time_get_nano();
+      for (i = 0; i < num_runs; i++)
+         translate->run_elts(translate, elts, num_verts, 0, 0, output);
+      int64_t indexed = os_time_get_nano() - start;
+
+      printf("%s translate_%s %s: %.2f ns/vertex linear, "
+             "%.2f ns/vertex indexed\n",
+             match ? "PASS" : "FAIL", name,
+             packed ? "packed" : "interleaved",
+             (double)linear / (num_runs * num_verts),
+             (double)indexed / (num_runs * num_verts));
+
+      translate->release(translate);
+   }
+
+   align_free(input);
+   align_free(output);
+   align_free(reference);
+   align_free(elts);
+   return all_match;
+}
+
 int main(int argc, char** argv)
 {
    struct translate *(*create_fn)(const struct translate_key *key) = 0;
@@ -99,10 +196,14 @@ int main(int argc, char** argv)
 
    if (!create_fn)
    {
-      printf("Usage: ./translate_test [default|generic|x86|nosse|sse|sse2|sse3|ssse3|sse4.1|avx]\n");
+      printf("Usage: ./translate_test [default|generic|x86|nosse|sse|sse2|sse3|ssse3|sse4.1|avx] [bench]\n");
       return 2;
    }
 
+   if (argc > 2 && !strcmp(argv[2], "bench")) {
+      return run_benchmark(create_fn, argv[1]) ? 0 : 1;
+   }
+
    for (i = 1; i < ARRAY_SIZE(buffer); ++i)
       buffer[i] = align_malloc(buffer_size, 4096);
 
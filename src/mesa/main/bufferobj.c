@@ -68,6 +68,28 @@
 #define BUFFER_WARNING_CALL_COUNT 4
 
 
+/**
+ * Mark a byte range of the buffer as written.  Min/max index cache entries
+ * overlapping it are dropped by the next cache lookup.
+ */
+static void
+invalidate_minmax_cache(struct gl_buffer_object *bufObj,
+                        GLintptr offset, GLsizeiptr size)
+{
+   GLintptr end = size > INTPTR_MAX - offset ? INTPTR_MAX : offset + size;
+
+   if (bufObj->MinMaxCacheDirty) {
+      bufObj->MinMaxCacheDirtyStart = MIN2(bufObj->MinMaxCacheDirtyStart,
+                                           offset);
+      bufObj->MinMaxCacheDirtyEnd = MAX2(bufObj->MinMaxCacheDirtyEnd, end);
+   } else {
+      bufObj->MinMaxCacheDirtyStart = offset;
+      bufObj->MinMaxCacheDirtyEnd = end;
+      bufObj->MinMaxCacheDirty = true;
+   }
+}
+
+
 /**
  * Replace data in a subrange of buffer object.  If the data range
  * specified by size + offset extends beyond the end of the buffer or
@@ -570,7 +592,7 @@ bufferobj_copy_subdata(struct gl_context *ctx,
    struct pipe_context *pipe = ctx->pipe;
    struct pipe_box box;
 
-   dst->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(dst, writeOffset, size);
    if (!size)
       return;
 
@@ -2156,7 +2178,7 @@ buffer_storage(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    FLUSH_VERTICES(ctx, 0, 0);
 
    bufObj->Immutable = GL_TRUE;
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj, 0, INTPTR_MAX);
 
    if (memObj) {
       res = bufferobj_data_mem(ctx, target, size, memObj, offset,
@@ -2401,7 +2423,7 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
 
    FLUSH_VERTICES(ctx, 0, 0);
 
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj, 0, INTPTR_MAX);
 
 #ifdef VBO_DEBUG
    printf("glBufferDataARB(%u, sz %ld, from %p, usage 0x%x)\n",
@@ -2588,7 +2610,7 @@ _mesa_buffer_sub_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
       return;
 
    bufObj->NumSubDataCalls++;
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj, offset, size);
 
    _mesa_bufferobj_subdata(ctx, offset, size, data, bufObj);
 }
@@ -2793,7 +2815,7 @@ clear_buffer_sub_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    if (size == 0)
       return;
 
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj, offset, size);
 
    if (!ctx->pipe->clear_buffer) {
       clear_buffer_subdata_sw(ctx, offset, size,
@@ -3707,7 +3729,7 @@ map_buffer_range(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    }
 
    if (access & GL_MAP_WRITE_BIT) {
-      bufObj->MinMaxCacheDirty = true;
+      invalidate_minmax_cache(bufObj, offset, length);
    }
 
 #ifdef VBO_DEBUG
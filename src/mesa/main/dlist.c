@@ -10862,6 +10862,15 @@ execute_list(struct gl_context *ctx, GLuint list)
    while (1) {
       const OpCode opcode = n[0].opcode;
 
+      /* Draws of consecutive vertex lists are merged, even across
+       * display lists, until any other command is executed.
+       */
+      if (opcode != OPCODE_VERTEX_LIST &&
+          opcode != OPCODE_VERTEX_LIST_COPY_CURRENT &&
+          opcode != OPCODE_CONTINUE &&
+          opcode != OPCODE_END_OF_LIST)
+         vbo_save_flush_merged_draws(ctx);
+
       switch (opcode) {
          case OPCODE_ERROR:
             _mesa_error(ctx, n[1].e, "%s", (const char *) get_pointer(&n[2]));
@@ -13452,6 +13461,7 @@ _mesa_CallList(GLuint list)
 
    _mesa_HashLockMutex(ctx->Shared->DisplayList);
    execute_list(ctx, list);
+   vbo_save_flush_merged_draws(ctx);
    _mesa_HashUnlockMutex(ctx->Shared->DisplayList);
    ctx->CompileFlag = save_compile_flag;
 
@@ -13575,6 +13585,7 @@ _mesa_CallLists(GLsizei n, GLenum type, const GLvoid * lists)
       break;
    }
 
+   vbo_save_flush_merged_draws(ctx);
    _mesa_HashUnlockMutex(ctx->Shared->DisplayList);
    ctx->CompileFlag = save_compile_flag;
 
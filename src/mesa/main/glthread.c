@@ -220,6 +220,7 @@ _mesa_glthread_init(struct gl_context *ctx)
    }
    glthread->next_batch = &glthread->batches[glthread->next];
    glthread->used = 0;
+   glthread->batch_limit = MARSHAL_MAX_CMD_SIZE / 8;
    glthread->stats.queue = &glthread->queue;
 
    glthread->LastDListChangeBatchIndex = -1;
@@ -338,6 +339,20 @@ _mesa_glthread_flush_batch(struct gl_context *ctx)
       }
    }
 
+   /* Adapt the batch size to the balance between the threads.  If the
+    * worker has already executed everything we gave it, it's waiting for us,
+    * so submit smaller batches to feed it sooner.  If batches are queued up,
+    * the worker is the bottleneck, so use bigger batches to minimize the
+    * queue overhead.
+    */
+   if (util_queue_fence_is_signalled(&glthread->batches[glthread->last].fence)) {
+      glthread->batch_limit = MAX2(glthread->batch_limit / 2,
+                                   MARSHAL_MIN_CMD_SIZE / 8);
+   } else {
+      glthread->batch_limit = MIN2(glthread->batch_limit * 2,
+                                   MARSHAL_MAX_CMD_SIZE / 8);
+   }
+
    struct glthread_batch *next = glthread->next_batch;
 
    p_atomic_add(&glthread->stats.num_offloaded_items, glthread->used);
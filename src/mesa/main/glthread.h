@@ -35,6 +35,15 @@
  */
 #define MARSHAL_MAX_CMD_SIZE (8 * 1024)
 
+/* The smallest batch size glthread adapts down to.
+ *
+ * Batches are submitted when they reach glthread_state::batch_limit, which
+ * moves between this and MARSHAL_MAX_CMD_SIZE: it shrinks while the worker
+ * thread runs out of work, so that it gets fed sooner, and grows back while
+ * batches are queued up behind it, to keep the queue overhead low.
+ */
+#define MARSHAL_MIN_CMD_SIZE (1 * 1024)
+
 /* The number of batch slots in memory.
  *
  * One batch is being executed, one batch is being filled, the rest are
@@ -209,6 +218,9 @@ struct glthread_state
    /** Number of uint64_t elements filled already. */
    unsigned used;
 
+   /** Number of uint64_t elements after which the batch is submitted. */
+   unsigned batch_limit;
+
    /** Upload buffer. */
    struct gl_buffer_object *upload_buffer;
    uint8_t *upload_ptr;
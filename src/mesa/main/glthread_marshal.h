@@ -62,7 +62,10 @@ _mesa_glthread_allocate_command(struct gl_context *ctx,
 
    assert (num_elements <= MARSHAL_MAX_CMD_SIZE / 8);
 
-   if (unlikely(glthread->used + num_elements > MARSHAL_MAX_CMD_SIZE / 8))
+   /* The batch buffer is always MARSHAL_MAX_CMD_SIZE bytes, so a call that
+    * is bigger than batch_limit still fits into an empty batch.
+    */
+   if (unlikely(glthread->used + num_elements > glthread->batch_limit))
       _mesa_glthread_flush_batch(ctx);
 
    struct glthread_batch *next = glthread->next_batch;
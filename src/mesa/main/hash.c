@@ -38,6 +38,8 @@
 #include "util/glheader.h"
 #include "hash.h"
 #include "util/hash_table.h"
+#include "util/u_atomic.h"
+#include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_idalloc.h"
 
@@ -91,6 +93,12 @@ _mesa_DeleteHashTable(struct _mesa_HashTable *table)
    }
 
    _mesa_hash_table_destroy(table->ht, NULL);
+   free(table->Dense);
+   while (table->RetiredDense) {
+      struct _mesa_HashDenseArray *next = table->RetiredDense->retired_next;
+      free(table->RetiredDense);
+      table->RetiredDense = next;
+   }
    if (table->id_alloc) {
       util_idalloc_fini(table->id_alloc);
       free(table->id_alloc);
@@ -129,6 +137,9 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
    assert(table);
    assert(key);
 
+   if (table->Dense && key < table->Dense->size)
+      return table->Dense->data[key];
+
    if (key == DELETED_KEY_VALUE)
       return table->deleted_key_data;
 
@@ -144,6 +155,11 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
 
 /**
  * Lookup an entry in the hash table.
+ *
+ * Keys covered by the dense array are looked up without taking the mutex.
+ * Writers update the array with release stores while holding the mutex, so
+ * this returns either the old or the new value of a concurrently modified
+ * entry, just like a locked lookup racing with the modification would.
  * 
  * \param table the hash table.
  * \param key the key.
@@ -153,6 +169,10 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
 void *
 _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 {
+   struct _mesa_HashDenseArray *dense = p_atomic_read(&table->Dense);
+   if (likely(dense && key < dense->size))
+      return p_atomic_read(&dense->data[key]);
+
    void *res;
    _mesa_HashLockMutex(table);
    res = _mesa_HashLookup_unlocked(table, key);
@@ -179,6 +199,53 @@ _mesa_HashLookupLocked(struct _mesa_HashTable *table, GLuint key)
 }
 
 
+/**
+ * Store data for key in the dense array, growing it if needed.  The hash
+ * table mutex must be held.
+ */
+static void
+dense_store(struct _mesa_HashTable *table, GLuint key, void *data)
+{
+   struct _mesa_HashDenseArray *dense = table->Dense;
+
+   if (key >= MESA_HASH_DENSE_MAX_KEYS)
+      return;
+
+   if (!dense || key >= dense->size) {
+      /* Removing a key that was never stored doesn't need a bigger array. */
+      if (!data)
+         return;
+
+      GLuint size = MAX2(util_next_power_of_two(key + 1), 64);
+      struct _mesa_HashDenseArray *grown =
+         calloc(1, sizeof(*grown) + size * sizeof(grown->data[0]));
+      if (!grown)
+         return;
+
+      /* Fill it from the hash table, which has every entry even if an
+       * earlier allocation failure left the dense array behind.
+       */
+      grown->size = size;
+      hash_table_foreach(table->ht, entry) {
+         GLuint entry_key = (uintptr_t)entry->key;
+         if (entry_key < size)
+            grown->data[entry_key] = entry->data;
+      }
+      grown->data[DELETED_KEY_VALUE] = table->deleted_key_data;
+
+      if (dense) {
+         dense->retired_next = table->RetiredDense;
+         table->RetiredDense = dense;
+      }
+
+      /* Publish the copy only once it is complete. */
+      p_atomic_set(&table->Dense, grown);
+      dense = grown;
+   }
+
+   p_atomic_set(&dense->data[key], data);
+}
+
 static inline void
 _mesa_HashInsert_unlocked(struct _mesa_HashTable *table, GLuint key, void *data)
 {
@@ -201,6 +268,8 @@ _mesa_HashInsert_unlocked(struct _mesa_HashTable *table, GLuint key, void *data)
          _mesa_hash_table_insert_pre_hashed(table->ht, hash, uint_key(key), data);
       }
    }
+
+   dense_store(table, key, data);
 }
 
 
@@ -280,6 +349,8 @@ _mesa_HashRemove_unlocked(struct _mesa_HashTable *table, GLuint key)
       _mesa_hash_table_remove(table->ht, entry);
    }
 
+   dense_store(table, key, NULL);
+
    if (table->id_alloc)
       util_idalloc_free(table->id_alloc, key);
 }
@@ -326,6 +397,10 @@ _mesa_HashDeleteAll(struct _mesa_HashTable *table,
       callback(table->deleted_key_data, userData);
       table->deleted_key_data = NULL;
    }
+   if (table->Dense) {
+      for (GLuint i = 0; i < table->Dense->size; i++)
+         p_atomic_set(&table->Dense->data[i], NULL);
+   }
    if (table->id_alloc) {
       util_idalloc_fini(table->id_alloc);
       free(table->id_alloc);
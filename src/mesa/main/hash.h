@@ -98,6 +98,26 @@ uint_key(GLuint id)
 }
 /** @} */
 
+/**
+ * Keys below this are also stored in _mesa_HashTable::Dense.  Larger keys
+ * are unusual (glGen* hands out small names) and only live in the hash
+ * table.
+ */
+#define MESA_HASH_DENSE_MAX_KEYS (1 << 20)
+
+/**
+ * Array of data pointers indexed by key, read without locking.
+ *
+ * It is never resized in place: growing it publishes a bigger copy and
+ * retires the old one, which stays allocated until the table is deleted
+ * so that concurrent readers can keep using it.
+ */
+struct _mesa_HashDenseArray {
+   struct _mesa_HashDenseArray *retired_next;
+   GLuint size;
+   void *data[];
+};
+
 /**
  * The hash table data structure.
  */
@@ -105,6 +125,10 @@ struct _mesa_HashTable {
    struct hash_table *ht;
    GLuint MaxKey;                        /**< highest key inserted so far */
    simple_mtx_t Mutex;                   /**< mutual exclusion lock */
+   /** Lock-free mirror of the entries with small keys, or NULL */
+   struct _mesa_HashDenseArray *Dense;
+   /** Dense arrays replaced by bigger ones, freed with the table */
+   struct _mesa_HashDenseArray *RetiredDense;
    /* Used when name reuse is enabled */
    struct util_idalloc* id_alloc;
 
@@ -1462,6 +1462,11 @@ struct gl_buffer_object
    unsigned MinMaxCacheMissIndices;
    struct hash_table *MinMaxCache;
    simple_mtx_t MinMaxCacheMutex;
+   /** Byte range written since the cache was last validated, only valid if
+    * MinMaxCacheDirty is set.
+    */
+   GLintptr MinMaxCacheDirtyStart;
+   GLintptr MinMaxCacheDirtyEnd;
    bool MinMaxCacheDirty:1;
 
    bool DeletePending:1;  /**< true if buffer object is removed from the hash */
@@ -30,66 +30,177 @@
 #include <smmintrin.h>
 #include <stdint.h>
 
-void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count)
+static inline __m128i
+minmax_min(unsigned bits, __m128i a, __m128i b)
 {
-   unsigned max_ui = 0;
-   unsigned min_ui = ~0U;
-   unsigned i = 0;
-   unsigned aligned_count = count;
+   switch (bits) {
+   case 8:  return _mm_min_epu8(a, b);
+   case 16: return _mm_min_epu16(a, b);
+   default: return _mm_min_epu32(a, b);
+   }
+}
 
-   /* handle the first few values without SSE until the pointer is aligned */
-   while (((uintptr_t)ui_indices & 15) && aligned_count) {
-      if (*ui_indices > max_ui)
-         max_ui = *ui_indices;
-      if (*ui_indices < min_ui)
-         min_ui = *ui_indices;
+static inline __m128i
+minmax_max(unsigned bits, __m128i a, __m128i b)
+{
+   switch (bits) {
+   case 8:  return _mm_max_epu8(a, b);
+   case 16: return _mm_max_epu16(a, b);
+   default: return _mm_max_epu32(a, b);
+   }
+}
 
-      aligned_count--;
-      ui_indices++;
+static inline __m128i
+minmax_cmpeq(unsigned bits, __m128i a, __m128i b)
+{
+   switch (bits) {
+   case 8:  return _mm_cmpeq_epi8(a, b);
+   case 16: return _mm_cmpeq_epi16(a, b);
+   default: return _mm_cmpeq_epi32(a, b);
    }
+}
 
-   /* TODO: The actual threshold for SSE begin useful may be higher than 8.
-    * Some careful microbenchmarks and measurement are required to
-    * find the actual tipping point.
-    */
-   if (aligned_count >= 8) {
-      alignas(16) unsigned max_arr[4];
-      alignas(16) unsigned min_arr[4];
-      unsigned vec_count;
-      __m128i max_ui4 = _mm_setzero_si128();
-      __m128i min_ui4 = _mm_set1_epi32(~0U);
-      __m128i ui_indices4;
-      __m128i *ui_indices_ptr;
-
-      vec_count = aligned_count & ~0x3;
-      ui_indices_ptr = (__m128i *)ui_indices;
-      for (i = 0; i < vec_count / 4; i++) {
-         ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
-         max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
-         min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
-      }
+static inline __m128i
+minmax_set1(unsigned bits, unsigned value)
+{
+   switch (bits) {
+   case 8:  return _mm_set1_epi8(value);
+   case 16: return _mm_set1_epi16(value);
+   default: return _mm_set1_epi32(value);
+   }
+}
+
+static inline unsigned
+minmax_reduce_min(unsigned bits, __m128i v)
+{
+   v = minmax_min(bits, v, _mm_srli_si128(v, 8));
+   v = minmax_min(bits, v, _mm_srli_si128(v, 4));
+   if (bits <= 16)
+      v = minmax_min(bits, v, _mm_srli_si128(v, 2));
+   if (bits == 8)
+      v = minmax_min(bits, v, _mm_srli_si128(v, 1));
+
+   return (unsigned)_mm_cvtsi128_si32(v) & BITFIELD_MASK(bits);
+}
+
+static inline unsigned
+minmax_reduce_max(unsigned bits, __m128i v)
+{
+   v = minmax_max(bits, v, _mm_srli_si128(v, 8));
+   v = minmax_max(bits, v, _mm_srli_si128(v, 4));
+   if (bits <= 16)
+      v = minmax_max(bits, v, _mm_srli_si128(v, 2));
+   if (bits == 8)
+      v = minmax_max(bits, v, _mm_srli_si128(v, 1));
 
-      _mm_store_si128((__m128i *)max_arr, max_ui4);
-      _mm_store_si128((__m128i *)min_arr, min_ui4);
+   return (unsigned)_mm_cvtsi128_si32(v) & BITFIELD_MASK(bits);
+}
+
+static inline unsigned
+minmax_load(unsigned bits, const void *indices, unsigned i)
+{
+   switch (bits) {
+   case 8:  return ((const uint8_t *)indices)[i];
+   case 16: return ((const uint16_t *)indices)[i];
+   default: return ((const uint32_t *)indices)[i];
+   }
+}
+
+/* Inlined with constant bits and restart so that each caller below gets
+ * its own specialized loop.
+ *
+ * Restart indices are replaced by all ones before taking the minimum and by
+ * zero before taking the maximum, so they never affect the result.
+ */
+static inline void
+index_array_min_max(unsigned bits, bool restart, unsigned restart_index,
+                    const void *indices, unsigned *min_index,
+                    unsigned *max_index, unsigned count)
+{
+   const unsigned lanes = 128 / bits;
+   unsigned min = ~0U;
+   unsigned max = 0;
+   unsigned i = 0;
 
-      for (i = 0; i < 4; i++) {
-         if (max_arr[i] > max_ui)
-            max_ui = max_arr[i];
-         if (min_arr[i] < min_ui)
-            min_ui = min_arr[i];
+   if (count >= lanes) {
+      const __m128i restart_vec = minmax_set1(bits, restart_index);
+      __m128i min_vec = _mm_set1_epi32(~0);
+      __m128i max_vec = _mm_setzero_si128();
+
+      for (; i + lanes <= count; i += lanes) {
+         __m128i v = _mm_loadu_si128((const __m128i *)
+                                     ((const uint8_t *)indices + i * bits / 8));
+         if (restart) {
+            __m128i is_restart = minmax_cmpeq(bits, v, restart_vec);
+            min_vec = minmax_min(bits, min_vec, _mm_or_si128(v, is_restart));
+            max_vec = minmax_max(bits, max_vec, _mm_andnot_si128(is_restart, v));
+         } else {
+            min_vec = minmax_min(bits, min_vec, v);
+            max_vec = minmax_max(bits, max_vec, v);
+         }
       }
-      i = vec_count;
+
+      min = minmax_reduce_min(bits, min_vec);
+      max = minmax_reduce_max(bits, max_vec);
    }
 
-   for (; i < aligned_count; i++) {
-      if (ui_indices[i] > max_ui)
-         max_ui = ui_indices[i];
-      if (ui_indices[i] < min_ui)
-         min_ui = ui_indices[i];
+   for (; i < count; i++) {
+      unsigned v = minmax_load(bits, indices, i);
+      if (restart && v == restart_index)
+         continue;
+      if (v > max)
+         max = v;
+      if (v < min)
+         min = v;
    }
 
-   *min_index = min_ui;
-   *max_index = max_ui;
+   /* If every index was a restart index, the vector loop leaves the minimum
+    * at the largest value of the index type.  Match the scalar code, which
+    * returns an empty range of ~0 .. 0.
+    */
+   if (min > max)
+      min = ~0U;
+
+   *min_index = min;
+   *max_index = max;
+}
+
+void
+_mesa_index_array_min_max(unsigned index_size, bool restart,
+                          unsigned restart_index, const void *indices,
+                          unsigned *min_index, unsigned *max_index,
+                          unsigned count)
+{
+   /* A restart index that doesn't fit in the index type never matches. */
+   if (index_size < 4 && restart_index > BITFIELD_MASK(index_size * 8))
+      restart = false;
+
+   switch (index_size) {
+   case 4:
+      if (restart)
+         index_array_min_max(32, true, restart_index, indices,
+                             min_index, max_index, count);
+      else
+         index_array_min_max(32, false, 0, indices,
+                             min_index, max_index, count);
+      break;
+   case 2:
+      if (restart)
+         index_array_min_max(16, true, restart_index, indices,
+                             min_index, max_index, count);
+      else
+         index_array_min_max(16, false, 0, indices,
+                             min_index, max_index, count);
+      break;
+   case 1:
+      if (restart)
+         index_array_min_max(8, true, restart_index, indices,
+                             min_index, max_index, count);
+      else
+         index_array_min_max(8, false, 0, indices,
+                             min_index, max_index, count);
+      break;
+   default:
+      unreachable("not reached");
+   }
 }
@@ -28,8 +28,17 @@
 #ifndef SSE_MINMAX_H
 #define SSE_MINMAX_H
 
+#include <stdbool.h>
+
+/**
+ * Compute the minimum and maximum of an array of 1, 2 or 4 byte indices,
+ * skipping restart_index if restart is set.  If there are no indices left,
+ * min_index is ~0 and max_index is 0.  Requires SSE 4.1.
+ */
 void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count);
+_mesa_index_array_min_max(unsigned index_size, bool restart,
+                          unsigned restart_index, const void *indices,
+                          unsigned *min_index, unsigned *max_index,
+                          unsigned count);
 
 #endif /* SSE_MINMAX_H */
@@ -278,15 +278,16 @@ st_bind_ubos(struct st_context *st, struct gl_program *prog,
 
    for (i = 0; i < prog->sh.NumUniformBlocks; i++) {
       struct gl_buffer_binding *binding;
+      struct pipe_resource *buffer;
 
       binding =
          &st->ctx->UniformBufferBindings[prog->sh.UniformBlocks[i]->Binding];
 
-      cb.buffer = _mesa_get_bufferobj_reference(st->ctx, binding->BufferObject);
+      buffer = binding->BufferObject ? binding->BufferObject->buffer : NULL;
 
-      if (cb.buffer) {
+      if (buffer) {
          cb.buffer_offset = binding->Offset;
-         cb.buffer_size = cb.buffer->width0 - binding->Offset;
+         cb.buffer_size = buffer->width0 - binding->Offset;
 
          /* AutomaticSize is FALSE if the buffer was set with BindBufferRange.
           * Take the minimum just to be sure.
@@ -299,6 +300,20 @@ st_bind_ubos(struct st_context *st, struct gl_program *prog,
          cb.buffer_size = 0;
       }
 
+      /* Skip slots that are already bound to the same range. Any change of
+       * a uniform buffer binding flags all blocks of all stages, so most
+       * of them are usually unchanged.
+       */
+      if (st->state.ubos[shader_type][i].buffer == buffer &&
+          st->state.ubos[shader_type][i].offset == cb.buffer_offset &&
+          st->state.ubos[shader_type][i].size == cb.buffer_size)
+         continue;
+
+      st->state.ubos[shader_type][i].buffer = buffer;
+      st->state.ubos[shader_type][i].offset = cb.buffer_offset;
+      st->state.ubos[shader_type][i].size = cb.buffer_size;
+
+      cb.buffer = _mesa_get_bufferobj_reference(st->ctx, binding->BufferObject);
       pipe->set_constant_buffer(pipe, shader_type, 1 + i, true, &cb);
    }
 }
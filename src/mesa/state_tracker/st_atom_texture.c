@@ -283,9 +283,50 @@ update_textures(struct st_context *st,
    unsigned old_num_textures = st->state.num_sampler_views[shader_stage];
    unsigned num_unbind = old_num_textures > num_textures ?
                             old_num_textures - num_textures : 0;
+   struct pipe_sampler_view **bound = st->state.sampler_views[shader_stage];
+
+   if (!(st->state.sampler_views_valid & BITFIELD_BIT(shader_stage))) {
+      pipe->set_sampler_views(pipe, shader_stage, 0, num_textures, num_unbind,
+                              true, sampler_views);
+      memcpy(bound, sampler_views, num_textures * sizeof(*bound));
+      memset(&bound[num_textures], 0,
+             (PIPE_MAX_SAMPLERS - num_textures) * sizeof(*bound));
+      st->state.sampler_views_valid |= BITFIELD_BIT(shader_stage);
+      st->state.num_sampler_views[shader_stage] = num_textures;
+      return;
+   }
+
+   /* Only rebind the range of slots that changed. This is common when the
+    * atom is flagged dirty by a change in a different texture unit.
+    */
+   unsigned num_slots = num_textures + num_unbind;
+   int first = -1, last = -1;
 
-   pipe->set_sampler_views(pipe, shader_stage, 0, num_textures, num_unbind,
-                           true, sampler_views);
+   for (unsigned i = 0; i < num_slots; i++) {
+      struct pipe_sampler_view *view = i < num_textures ? sampler_views[i] : NULL;
+
+      if (view != bound[i]) {
+         if (first < 0)
+            first = i;
+         last = i;
+      }
+   }
+
+   /* Drop the references of the views that don't have to be rebound. */
+   for (unsigned i = 0; i < num_textures; i++) {
+      if (first < 0 || i < first || i > last)
+         pipe_sampler_view_reference(&sampler_views[i], NULL);
+   }
+
+   if (first >= 0) {
+      for (unsigned i = num_textures; i <= last; i++)
+         sampler_views[i] = NULL;
+
+      pipe->set_sampler_views(pipe, shader_stage, first, last - first + 1, 0,
+                              true, &sampler_views[first]);
+      memcpy(&bound[first], &sampler_views[first],
+             (last - first + 1) * sizeof(*bound));
+   }
    st->state.num_sampler_views[shader_stage] = num_textures;
 }
 
@@ -192,6 +192,7 @@ try_pbo_readpixels(struct st_context *st, struct gl_renderbuffer *rb,
                               false, &sampler_view);
       st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] =
          MAX2(st->state.num_sampler_views[PIPE_SHADER_FRAGMENT], 1);
+      st_invalidate_bound_sampler_views(st, PIPE_SHADER_FRAGMENT);
 
       pipe_sampler_view_reference(&sampler_view, NULL);
 
@@ -258,6 +259,7 @@ fail:
     */
    cso_restore_state(cso, CSO_UNBIND_FS_SAMPLERVIEWS | CSO_UNBIND_FS_IMAGE0);
    st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] = 0;
+   st_invalidate_bound_sampler_views(st, PIPE_SHADER_FRAGMENT);
 
    st->ctx->Array.NewVertexElements = true;
    st->ctx->NewDriverState |= ST_NEW_FS_CONSTANTS |
@@ -1717,6 +1717,7 @@ try_pbo_upload_common(struct gl_context *ctx,
                               false, &sampler_view);
       st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] =
          MAX2(st->state.num_sampler_views[PIPE_SHADER_FRAGMENT], 1);
+      st_invalidate_bound_sampler_views(st, PIPE_SHADER_FRAGMENT);
 
       pipe_sampler_view_reference(&sampler_view, NULL);
    }
@@ -1756,6 +1757,7 @@ fail:
     */
    cso_restore_state(cso, CSO_UNBIND_FS_SAMPLERVIEWS);
    st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] = 0;
+   st_invalidate_bound_sampler_views(st, PIPE_SHADER_FRAGMENT);
 
    ctx->Array.NewVertexElements = true;
    ctx->NewDriverState |= ST_NEW_VERTEX_ARRAYS |
@@ -1984,6 +1986,7 @@ try_pbo_download(struct st_context *st,
          goto fail;
 
       pipe->set_sampler_views(pipe, PIPE_SHADER_FRAGMENT, 0, 1, 0, true, &sampler_view);
+      st_invalidate_bound_sampler_views(st, PIPE_SHADER_FRAGMENT);
       sampler_view = NULL;
 
       cso_set_samplers(cso, PIPE_SHADER_FRAGMENT, 1, samplers);
@@ -2046,6 +2049,7 @@ fail:
     */
    cso_restore_state(cso, CSO_UNBIND_FS_SAMPLERVIEWS | CSO_UNBIND_FS_IMAGE0);
    st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] = 0;
+   st_invalidate_bound_sampler_views(st, PIPE_SHADER_FRAGMENT);
 
    st->ctx->Array.NewVertexElements = true;
    st->ctx->NewDriverState |= ST_NEW_FS_CONSTANTS |
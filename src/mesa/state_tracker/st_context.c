@@ -65,6 +65,7 @@
 #include "util/u_upload_mgr.h"
 #include "util/u_vbuf.h"
 #include "util/u_memory.h"
+#include "util/os_time.h"
 #include "util/hash_table.h"
 #include "cso_cache/cso_context.h"
 #include "compiler/glsl/glsl_parser_extras.h"
@@ -74,6 +75,13 @@ DEBUG_GET_ONCE_BOOL_OPTION(mesa_mvp_dp4, "MESA_MVP_DP4", false)
 /* The list of state update functions. */
 st_update_func_t st_update_functions[ST_NUM_ATOMS];
 
+/* Atom names for the HUD, without the "st_" prefix. */
+static const char *const st_atom_names[ST_NUM_ATOMS] = {
+#define ST_STATE(FLAG, st_update) [FLAG##_INDEX] = #st_update + 3,
+#include "st_atom_list.h"
+#undef ST_STATE
+};
+
 static void
 init_atoms_once(void)
 {
@@ -87,6 +95,22 @@ init_atoms_once(void)
       st_update_functions[ST_NEW_VERTEX_ARRAYS_INDEX] = st_update_array_with_popcnt;
 }
 
+/**
+ * Same as the loop in st_validate_state, but it also measures the time spent
+ * in each atom. This is only used when the HUD displays it.
+ */
+void
+st_validate_state_timed(struct st_context *st, uint64_t dirty)
+{
+   while (dirty) {
+      unsigned i = u_bit_scan64(&dirty);
+      int64_t start = os_time_get_nano();
+
+      st_update_functions[i](st);
+      st->atom_time_ns[i] += os_time_get_nano() - start;
+   }
+}
+
 void
 st_invalidate_buffers(struct st_context *st)
 {
@@ -531,6 +555,20 @@ st_create_context_priv(struct gl_context *ctx, struct pipe_context *pipe,
       st->util_velems.velems[2].src_format = PIPE_FORMAT_R32G32_FLOAT;
    }
 
+   /* Create the vertex elements and rasterizer states of the clear, bitmap
+    * and drawpixels quads ahead of time, so that the first use of these
+    * paths doesn't have to create them.
+    */
+   {
+      struct cso_velems_state velems = st->util_velems;
+
+      velems.count = 1;
+      cso_precreate_vertex_elements(st->cso_context, &velems);
+      velems.count = 3;
+      cso_precreate_vertex_elements(st->cso_context, &velems);
+      cso_precreate_rasterizer(st->cso_context, &st->clear.raster);
+   }
+
    ctx->Const.PackedDriverUniformStorage =
       screen->get_param(screen, PIPE_CAP_PACKED_UNIFORMS);
 
@@ -809,6 +847,10 @@ st_create_context_priv(struct gl_context *ctx, struct pipe_context *pipe,
                                         BITFIELD_BIT(MESA_PRIM_PATCHES);
    st->active_states = _mesa_get_active_states(ctx);
 
+   st->atom_timing.num_atoms = ST_NUM_ATOMS;
+   st->atom_timing.names = st_atom_names;
+   st->atom_timing.time_ns = st->atom_time_ns;
+
    return st;
 }
 
@@ -224,6 +224,21 @@ struct st_context
       GLuint num_frag_samplers;
       GLuint num_sampler_views[PIPE_SHADER_TYPES];
       unsigned num_images[PIPE_SHADER_TYPES];
+
+      /* Sampler views and uniform buffers last bound by the atoms, so that
+       * only the slots that changed are rebound. These don't hold
+       * references; the driver keeps bound objects alive. Sampler views are
+       * only valid for the shader stages set in sampler_views_valid, because
+       * meta ops also bind sampler views.
+       */
+      struct pipe_sampler_view *sampler_views[PIPE_SHADER_TYPES][PIPE_MAX_SAMPLERS];
+      unsigned sampler_views_valid;
+      struct {
+         struct pipe_resource *buffer;
+         unsigned offset;
+         unsigned size;
+      } ubos[PIPE_SHADER_TYPES][PIPE_MAX_CONSTANT_BUFFERS];
+
       struct pipe_clip_state clip;
       unsigned constbuf0_enabled_shader_mask;
       unsigned fb_width;
@@ -254,6 +269,10 @@ struct st_context
    /** This masks out unused shader resources. Only valid in draw calls. */
    uint64_t active_states;
 
+   /** CPU time spent in each atom, updated only when the HUD shows it. */
+   struct st_atom_timing atom_timing;
+   uint64_t atom_time_ns[ST_NUM_ATOMS];
+
    /**
     * The number of currently active queries (excluding timer queries).
     * This is used to know if we need to pause any queries for meta ops.
@@ -440,6 +459,17 @@ st_context(struct gl_context *ctx)
    return ctx->st;
 }
 
+/*
+ * Notify the texture atoms that sampler views of the given shader stage
+ * have been bound behind their back, e.g. by meta ops.
+ */
+static inline void
+st_invalidate_bound_sampler_views(struct st_context *st,
+                                  enum pipe_shader_type shader)
+{
+   st->state.sampler_views_valid &= ~BITFIELD_BIT(shader);
+}
+
 
 extern struct st_context *
 st_create_context(gl_api api, struct pipe_context *pipe,
@@ -521,6 +551,9 @@ typedef void (*st_update_func_t)(struct st_context *st);
 
 extern st_update_func_t st_update_functions[ST_NUM_ATOMS];
 
+void
+st_validate_state_timed(struct st_context *st, uint64_t dirty);
+
 #ifdef __cplusplus
 }
 #endif
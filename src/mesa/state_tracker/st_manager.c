@@ -916,8 +916,10 @@ st_context_invalidate_state(struct st_context *st, unsigned flags)
 {
    struct gl_context *ctx = st->ctx;
 
-   if (flags & ST_INVALIDATE_FS_SAMPLER_VIEWS)
+   if (flags & ST_INVALIDATE_FS_SAMPLER_VIEWS) {
       ctx->NewDriverState |= ST_NEW_FS_SAMPLER_VIEWS;
+      st_invalidate_bound_sampler_views(st, PIPE_SHADER_FRAGMENT);
+   }
    if (flags & ST_INVALIDATE_FS_CONSTBUF0)
       ctx->NewDriverState |= ST_NEW_FS_CONSTANTS;
    if (flags & ST_INVALIDATE_VS_CONSTBUF0)
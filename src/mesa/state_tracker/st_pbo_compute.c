@@ -1119,6 +1119,7 @@ download_texture_compute(struct st_context *st,
                               &sampler_view);
       st->state.num_sampler_views[PIPE_SHADER_COMPUTE] =
          MAX2(st->state.num_sampler_views[PIPE_SHADER_COMPUTE], 1);
+      st_invalidate_bound_sampler_views(st, PIPE_SHADER_COMPUTE);
 
       pipe_sampler_view_reference(&sampler_view, NULL);
 
@@ -1173,6 +1174,7 @@ fail:
                            st->state.num_sampler_views[PIPE_SHADER_COMPUTE],
                            false, NULL);
    st->state.num_sampler_views[PIPE_SHADER_COMPUTE] = 0;
+   st_invalidate_bound_sampler_views(st, PIPE_SHADER_COMPUTE);
    pipe->set_shader_buffers(pipe, PIPE_SHADER_COMPUTE, 0, 1, NULL, 0);
 
    st->ctx->NewDriverState |= ST_NEW_CS_CONSTANTS |
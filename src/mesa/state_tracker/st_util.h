@@ -118,6 +118,11 @@ st_validate_state(struct st_context *st, uint64_t pipeline_state_mask)
    if (dirty) {
       ctx->NewDriverState &= ~dirty;
 
+      if (unlikely(st->atom_timing.enabled)) {
+         st_validate_state_timed(st, dirty);
+         return;
+      }
+
       /* Execute functions that set states that have been changed since
        * the last draw.
        *
@@ -176,6 +176,17 @@ struct vbo_save_context {
    GLboolean dangling_attr_ref;
    GLboolean out_of_memory;  /**< True if last VBO allocation failed */
    bool no_current_update;
+
+   /**
+    * Draws of consecutive display list nodes that are submitted together,
+    * see vbo_save_flush_merged_draws.
+    */
+   struct {
+      const struct vbo_save_vertex_list *node; /**< first merged node */
+      struct pipe_draw_start_count_bias *draws;
+      unsigned num_draws;
+      unsigned max_draws;
+   } merged;
 };
 
 GLboolean
@@ -93,6 +93,26 @@ vbo_use_minmax_cache(struct gl_buffer_object *bufferObj)
 }
 
 
+/**
+ * Drop the cache entries whose indices overlap the byte range [start, end).
+ * Draws from untouched parts of the buffer keep hitting the cache.
+ */
+static void
+vbo_minmax_cache_invalidate_range(struct hash_table *cache,
+                                  GLintptr start, GLintptr end)
+{
+   hash_table_foreach(cache, entry) {
+      const struct minmax_cache_key *key = entry->key;
+      GLintptr key_end = key->offset + (GLintptr)key->count * key->index_size;
+
+      if (key->offset < end && key_end > start) {
+         vbo_minmax_cache_delete_entry(entry);
+         _mesa_hash_table_remove(cache, entry);
+      }
+   }
+}
+
+
 void
 vbo_delete_minmax_cache(struct gl_buffer_object *bufferObj)
 {
@@ -134,9 +154,10 @@ vbo_get_minmax_cached(struct gl_buffer_object *bufferObj,
          goto out_disable;
       }
 
-      _mesa_hash_table_clear(bufferObj->MinMaxCache, vbo_minmax_cache_delete_entry);
+      vbo_minmax_cache_invalidate_range(bufferObj->MinMaxCache,
+                                        bufferObj->MinMaxCacheDirtyStart,
+                                        bufferObj->MinMaxCacheDirtyEnd);
       bufferObj->MinMaxCacheDirty = false;
-      goto out_invalidate;
    }
 
    key.index_size = index_size;
@@ -151,7 +172,6 @@ vbo_get_minmax_cached(struct gl_buffer_object *bufferObj,
       found = GL_TRUE;
    }
 
-out_invalidate:
    if (found) {
       /* The hit counter saturates so that we don't accidently disable the
        * cache in a long-running program.
@@ -234,6 +254,14 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
                             const void *indices,
                             unsigned *min_index, unsigned *max_index)
 {
+#if defined(USE_SSE41)
+   if (util_get_cpu_caps()->has_sse4_1) {
+      _mesa_index_array_min_max(index_size, restart, restartIndex, indices,
+                                min_index, max_index, count);
+      return;
+   }
+#endif
+
    switch (index_size) {
    case 4: {
       const GLuint *ui_indices = (const GLuint *)indices;
@@ -248,16 +276,10 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
          }
       }
       else {
-#if defined(USE_SSE41)
-         if (util_get_cpu_caps()->has_sse4_1) {
-            _mesa_uint_array_min_max(ui_indices, &min_ui, &max_ui, count);
+         for (unsigned i = 0; i < count; i++) {
+            if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
+            if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
          }
-         else
-#endif
-            for (unsigned i = 0; i < count; i++) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
       }
       *min_index = min_ui;
       *max_index = max_ui;
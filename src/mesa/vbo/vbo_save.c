@@ -75,5 +75,9 @@ void vbo_save_destroy( struct gl_context *ctx )
    if (save->copied.buffer)
       free(save->copied.buffer);
 
+   free(save->merged.draws);
+   save->merged.draws = NULL;
+   save->merged.max_draws = 0;
+
    _mesa_reference_buffer_object(ctx, &save->current_bo, NULL);
 }
@@ -146,6 +146,9 @@ void _vbo_loopback_vertex_list(struct gl_context *ctx,
 void
 vbo_save_playback_vertex_list(struct gl_context *ctx, void *data, bool copy_to_current);
 
+void
+vbo_save_flush_merged_draws(struct gl_context *ctx);
+
 void
 vbo_save_playback_vertex_list_loopback(struct gl_context *ctx, void *data);
 
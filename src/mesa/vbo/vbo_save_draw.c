@@ -190,19 +190,166 @@ enum vbo_save_status {
    USE_SLOW_PATH,
 };
 
+/**
+ * Pass one reference of the node's vertex state to the driver.
+ */
+static void
+take_vertex_state_reference(struct gl_context *ctx,
+                            const struct vbo_save_vertex_list *node,
+                            gl_vertex_processing_mode mode,
+                            struct pipe_draw_vertex_state_info *info)
+{
+   info->take_vertex_state_ownership = false;
+
+   if (node->ctx == ctx) {
+      /* This mechanism allows passing references to the driver without
+       * using atomics to increase the reference count.
+       *
+       * This private refcount can be decremented without atomics but only
+       * one context (ctx above) can use this counter (so that it's only
+       * used by 1 thread).
+       *
+       * This number is atomically added to reference.count at
+       * initialization. If it's never used, the same number is atomically
+       * subtracted from reference.count before destruction. If this number
+       * is decremented, we can pass one reference to the driver without
+       * touching reference.count with atomics. At destruction we only
+       * subtract the number of references we have not returned. This can
+       * possibly turn a million atomic increments into 1 add and 1 subtract
+       * atomic op over the whole lifetime of an app.
+       */
+      int16_t * const private_refcount = (int16_t*)&node->private_refcount[mode];
+      assert(*private_refcount >= 0);
+
+      if (unlikely(*private_refcount == 0)) {
+         /* pipe_vertex_state can be reused through util_vertex_state_cache,
+          * and there can be many display lists over-incrementing this number,
+          * causing it to overflow.
+          *
+          * Guess that the same state can never be used by N=500000 display
+          * lists, so one display list can only increment it by
+          * INT_MAX / N.
+          */
+         const int16_t add_refs = INT_MAX / 500000;
+         p_atomic_add(&node->state[mode]->reference.count, add_refs);
+         *private_refcount = add_refs;
+      }
+
+      (*private_refcount)--;
+      info->take_vertex_state_ownership = true;
+   }
+}
+
+/**
+ * Append the draws of a node to the pending merged draw.
+ *
+ * Return false if the draws couldn't be queued, in which case the caller
+ * must draw the node itself.
+ */
+static bool
+merge_draws(struct vbo_save_context *save,
+            const struct vbo_save_vertex_list *node)
+{
+   const struct pipe_draw_start_count_bias *draws =
+      node->num_draws > 1 ? node->start_counts : &node->start_count;
+   unsigned num_draws = save->merged.num_draws + node->num_draws;
+
+   assert(!node->modes);
+
+   if (num_draws > save->merged.max_draws) {
+      unsigned max_draws = MAX3(64, save->merged.max_draws * 2, num_draws);
+      struct pipe_draw_start_count_bias *new_draws =
+         realloc(save->merged.draws, max_draws * sizeof(*new_draws));
+
+      if (!new_draws)
+         return false;
+
+      save->merged.draws = new_draws;
+      save->merged.max_draws = max_draws;
+   }
+
+   memcpy(&save->merged.draws[save->merged.num_draws], draws,
+          node->num_draws * sizeof(*draws));
+   save->merged.num_draws = num_draws;
+   if (!save->merged.node)
+      save->merged.node = node;
+   return true;
+}
+
+/**
+ * Submit the draws merged from consecutive display list nodes.
+ *
+ * All merged nodes share the same pipe_vertex_state, vertex processing mode
+ * and primitive type, and no GL state has changed between them, so they can
+ * be drawn by a single multi-draw call.
+ */
+void
+vbo_save_flush_merged_draws(struct gl_context *ctx)
+{
+   struct vbo_save_context *save = &vbo_context(ctx)->save;
+   const struct vbo_save_vertex_list *node = save->merged.node;
+
+   if (!node)
+      return;
+
+   if (save->merged.num_draws) {
+      const gl_vertex_processing_mode mode = ctx->VertexProgram._VPMode;
+      struct pipe_draw_vertex_state_info info;
+
+      info.mode = node->mode;
+      take_vertex_state_reference(ctx, node, mode, &info);
+
+      /* Set edge flags. */
+      _mesa_update_edgeflag_state_explicit(ctx, node->enabled_attribs[mode] &
+                                                VERT_BIT_EDGEFLAG);
+
+      ctx->Driver.DrawGalliumVertexState(ctx, node->state[mode], info,
+                                         save->merged.draws, NULL,
+                                         save->merged.num_draws);
+
+      /* Restore edge flag state and ctx->VertexProgram._VaryingInputs. */
+      _mesa_update_edgeflag_state_vao(ctx);
+   }
+
+   save->merged.node = NULL;
+   save->merged.num_draws = 0;
+}
+
 static enum vbo_save_status
 vbo_save_playback_vertex_list_gallium(struct gl_context *ctx,
                                       const struct vbo_save_vertex_list *node,
                                       bool copy_to_current)
 {
+   struct vbo_save_context *save = &vbo_context(ctx)->save;
+   const gl_vertex_processing_mode mode = ctx->VertexProgram._VPMode;
+   const struct vbo_save_vertex_list *first = save->merged.node;
+
+   /* Nothing has happened since the previous node was validated, so if this
+    * node uses the same vertex state and primitive type, its draws can be
+    * merged with the previous ones without validating anything.
+    */
+   if (first) {
+      if (!ctx->NewState && !node->modes &&
+          node->state[mode] == first->state[mode] &&
+          node->enabled_attribs[mode] == first->enabled_attribs[mode] &&
+          node->mode == first->mode &&
+          merge_draws(save, node)) {
+         if (copy_to_current) {
+            vbo_save_flush_merged_draws(ctx);
+            playback_copy_to_current(ctx, node);
+         }
+         return DONE;
+      }
+
+      vbo_save_flush_merged_draws(ctx);
+   }
+
    /* Don't use this if selection or feedback mode is enabled. st/mesa can't
     * handle it.
     */
    if (!ctx->Driver.DrawGalliumVertexState || ctx->RenderMode != GL_RENDER)
       return USE_SLOW_PATH;
 
-   const gl_vertex_processing_mode mode = ctx->VertexProgram._VPMode;
-
    /* This sets which vertex arrays are enabled, which determines
     * which attribs have stride = 0 and whether edge flags are enabled.
     */
@@ -232,49 +379,23 @@ vbo_save_playback_vertex_list_gallium(struct gl_context *ctx,
    if (vp->info.inputs_read & ~enabled || vp->DualSlotInputs)
       return USE_SLOW_PATH;
 
+   /* Defer the draws, so that the following nodes can be merged with them.
+    * Copying to current may change state that the next node depends on,
+    * so it ends the merged draw.
+    */
+   if (!node->modes && merge_draws(save, node)) {
+      if (copy_to_current) {
+         vbo_save_flush_merged_draws(ctx);
+         playback_copy_to_current(ctx, node);
+      }
+      return DONE;
+   }
+
    struct pipe_vertex_state *state = node->state[mode];
    struct pipe_draw_vertex_state_info info;
 
    info.mode = node->mode;
-   info.take_vertex_state_ownership = false;
-
-   if (node->ctx == ctx) {
-      /* This mechanism allows passing references to the driver without
-       * using atomics to increase the reference count.
-       *
-       * This private refcount can be decremented without atomics but only
-       * one context (ctx above) can use this counter (so that it's only
-       * used by 1 thread).
-       *
-       * This number is atomically added to reference.count at
-       * initialization. If it's never used, the same number is atomically
-       * subtracted from reference.count before destruction. If this number
-       * is decremented, we can pass one reference to the driver without
-       * touching reference.count with atomics. At destruction we only
-       * subtract the number of references we have not returned. This can
-       * possibly turn a million atomic increments into 1 add and 1 subtract
-       * atomic op over the whole lifetime of an app.
-       */
-      int16_t * const private_refcount = (int16_t*)&node->private_refcount[mode];
-      assert(*private_refcount >= 0);
-
-      if (unlikely(*private_refcount == 0)) {
-         /* pipe_vertex_state can be reused through util_vertex_state_cache,
-          * and there can be many display lists over-incrementing this number,
-          * causing it to overflow.
-          *
-          * Guess that the same state can never be used by N=500000 display
-          * lists, so one display list can only increment it by
-          * INT_MAX / N.
-          */
-         const int16_t add_refs = INT_MAX / 500000;
-         p_atomic_add(&state->reference.count, add_refs);
-         *private_refcount = add_refs;
-      }
-
-      (*private_refcount)--;
-      info.take_vertex_state_ownership = true;
-   }
+   take_vertex_state_reference(ctx, node, mode, &info);
 
    /* Set edge flags. */
    _mesa_update_edgeflag_state_explicit(ctx, enabled & VERT_BIT_EDGEFLAG);
@@ -303,6 +424,10 @@ vbo_save_playback_vertex_list_gallium(struct gl_context *ctx,
  * Execute the buffer and save copied verts.
  * This is called from the display list code when executing
  * a drawing command.
+ *
+ * The draws may be deferred to be merged with the following nodes, so
+ * the caller must call vbo_save_flush_merged_draws before executing
+ * anything else.
  */
 void
 vbo_save_playback_vertex_list(struct gl_context *ctx, void *data, bool copy_to_current)
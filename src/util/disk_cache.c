@@ -252,6 +252,10 @@ disk_cache_type_create(const char *gpu_name,
    DRV_KEY_CPY(drv_key_blob, &ptr_size, ptr_size_size)
    DRV_KEY_CPY(drv_key_blob, &driver_flags, driver_flags_size)
 
+   _mesa_sha1_init(&cache->driver_keys_sha1);
+   _mesa_sha1_update(&cache->driver_keys_sha1, cache->driver_keys_blob,
+                     cache->driver_keys_blob_size);
+
    /* Seed our rand function */
    s_rand_xorshift128plus(cache->seed_xorshift128plus, true);
 
@@ -670,11 +674,9 @@ void
 disk_cache_compute_key(struct disk_cache *cache, const void *data, size_t size,
                        cache_key key)
 {
-   struct mesa_sha1 ctx;
+   /* Start from the already hashed driver keys. */
+   struct mesa_sha1 ctx = cache->driver_keys_sha1;
 
-   _mesa_sha1_init(&ctx);
-   _mesa_sha1_update(&ctx, cache->driver_keys_blob,
-                     cache->driver_keys_blob_size);
    _mesa_sha1_update(&ctx, data, size);
    _mesa_sha1_final(&ctx, key);
 }
@@ -24,6 +24,7 @@
 #ifndef DISK_CACHE_OS_H
 #define DISK_CACHE_OS_H
 
+#include "util/mesa-sha1.h"
 #include "util/u_queue.h"
 
 #if DETECT_OS_WINDOWS
@@ -90,6 +91,11 @@ struct disk_cache {
    uint8_t *driver_keys_blob;
    size_t driver_keys_blob_size;
 
+   /* SHA-1 state after hashing driver_keys_blob, which is the prefix of
+    * every key computed by disk_cache_compute_key.
+    */
+   struct mesa_sha1 driver_keys_sha1;
+
    disk_cache_put_cb blob_put_cb;
    disk_cache_get_cb blob_get_cb;
 
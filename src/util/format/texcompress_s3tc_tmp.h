@@ -173,6 +173,98 @@ static void fetch_2d_texel_rgba_dxt5(GLint srcRowStride, const GLubyte *pixdata,
 }
 
 
+/* Decode all 16 texels of a block at once: the palette is only built once
+ * instead of for every texel like in the fetch functions above.  The
+ * results are identical.
+ */
+static inline void dxt135_decode_block(const GLubyte *img_block_src,
+                                       GLuint dxt_type, GLchan texels[16][4])
+{
+   const GLushort color0 = img_block_src[0] | (img_block_src[1] << 8);
+   const GLushort color1 = img_block_src[2] | (img_block_src[3] << 8);
+   const GLuint bits = img_block_src[4] | (img_block_src[5] << 8) |
+      (img_block_src[6] << 16) | ((GLuint)img_block_src[7] << 24);
+   GLchan palette[4][4];
+
+   palette[0][RCOMP] = UBYTE_TO_CHAN( EXP5TO8R(color0) );
+   palette[0][GCOMP] = UBYTE_TO_CHAN( EXP6TO8G(color0) );
+   palette[0][BCOMP] = UBYTE_TO_CHAN( EXP5TO8B(color0) );
+   palette[0][ACOMP] = CHAN_MAX;
+   palette[1][RCOMP] = UBYTE_TO_CHAN( EXP5TO8R(color1) );
+   palette[1][GCOMP] = UBYTE_TO_CHAN( EXP6TO8G(color1) );
+   palette[1][BCOMP] = UBYTE_TO_CHAN( EXP5TO8B(color1) );
+   palette[1][ACOMP] = CHAN_MAX;
+   if ((dxt_type > 1) || (color0 > color1)) {
+      palette[2][RCOMP] = UBYTE_TO_CHAN( ((EXP5TO8R(color0) * 2 + EXP5TO8R(color1)) / 3) );
+      palette[2][GCOMP] = UBYTE_TO_CHAN( ((EXP6TO8G(color0) * 2 + EXP6TO8G(color1)) / 3) );
+      palette[2][BCOMP] = UBYTE_TO_CHAN( ((EXP5TO8B(color0) * 2 + EXP5TO8B(color1)) / 3) );
+      palette[2][ACOMP] = CHAN_MAX;
+      palette[3][RCOMP] = UBYTE_TO_CHAN( ((EXP5TO8R(color0) + EXP5TO8R(color1) * 2) / 3) );
+      palette[3][GCOMP] = UBYTE_TO_CHAN( ((EXP6TO8G(color0) + EXP6TO8G(color1) * 2) / 3) );
+      palette[3][BCOMP] = UBYTE_TO_CHAN( ((EXP5TO8B(color0) + EXP5TO8B(color1) * 2) / 3) );
+      palette[3][ACOMP] = CHAN_MAX;
+   }
+   else {
+      palette[2][RCOMP] = UBYTE_TO_CHAN( ((EXP5TO8R(color0) + EXP5TO8R(color1)) / 2) );
+      palette[2][GCOMP] = UBYTE_TO_CHAN( ((EXP6TO8G(color0) + EXP6TO8G(color1)) / 2) );
+      palette[2][BCOMP] = UBYTE_TO_CHAN( ((EXP5TO8B(color0) + EXP5TO8B(color1)) / 2) );
+      palette[2][ACOMP] = CHAN_MAX;
+      palette[3][RCOMP] = 0;
+      palette[3][GCOMP] = 0;
+      palette[3][BCOMP] = 0;
+      palette[3][ACOMP] = dxt_type == 1 ? UBYTE_TO_CHAN(0) : CHAN_MAX;
+   }
+
+   for (unsigned k = 0; k < 16; k++)
+      memcpy(texels[k], palette[(bits >> (2 * k)) & 3], sizeof(palette[0]));
+}
+
+static inline void decode_block_rgb_dxt1(const GLubyte *blksrc, GLchan texels[16][4])
+{
+   dxt135_decode_block(blksrc, 0, texels);
+}
+
+static inline void decode_block_rgba_dxt1(const GLubyte *blksrc, GLchan texels[16][4])
+{
+   dxt135_decode_block(blksrc, 1, texels);
+}
+
+static inline void decode_block_rgba_dxt3(const GLubyte *blksrc, GLchan texels[16][4])
+{
+   dxt135_decode_block(blksrc + 8, 2, texels);
+   for (unsigned k = 0; k < 16; k++) {
+      const GLubyte anibble = (blksrc[k / 2] >> (4 * (k & 1))) & 0xf;
+      texels[k][ACOMP] = UBYTE_TO_CHAN( (GLubyte)(EXP4TO8(anibble)) );
+   }
+}
+
+static inline void decode_block_rgba_dxt5(const GLubyte *blksrc, GLchan texels[16][4])
+{
+   const GLubyte alpha0 = blksrc[0];
+   const GLubyte alpha1 = blksrc[1];
+   const uint64_t codes = (uint64_t)blksrc[2] | ((uint64_t)blksrc[3] << 8) |
+      ((uint64_t)blksrc[4] << 16) | ((uint64_t)blksrc[5] << 24) |
+      ((uint64_t)blksrc[6] << 32) | ((uint64_t)blksrc[7] << 40);
+   GLchan alpha[8];
+
+   alpha[0] = UBYTE_TO_CHAN( alpha0 );
+   alpha[1] = UBYTE_TO_CHAN( alpha1 );
+   for (unsigned code = 2; code < 8; code++) {
+      if (alpha0 > alpha1)
+         alpha[code] = UBYTE_TO_CHAN( ((alpha0 * (8 - code) + (alpha1 * (code - 1))) / 7) );
+      else if (code < 6)
+         alpha[code] = UBYTE_TO_CHAN( ((alpha0 * (6 - code) + (alpha1 * (code - 1))) / 5) );
+      else if (code == 6)
+         alpha[code] = 0;
+      else
+         alpha[code] = CHAN_MAX;
+   }
+
+   dxt135_decode_block(blksrc + 8, 2, texels);
+   for (unsigned k = 0; k < 16; k++)
+      texels[k][ACOMP] = alpha[(codes >> (3 * k)) & 7];
+}
+
 /* weights used for error function, basically weights (unsquared 2/4/1) according to rgb->luminance conversion
    not sure if this really reflects visual perception */
 #define REDWEIGHT 4
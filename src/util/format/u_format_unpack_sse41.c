@@ -0,0 +1,227 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "util/detect_arch.h"
+#include "util/format/u_format.h"
+
+#if defined(USE_SSE41) && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64) && !defined(NO_FORMAT_ASM)
+
+#include <smmintrin.h>
+#include "u_format_pack.h"
+#include "util/u_cpu_detect.h"
+
+/* All of the formats below are little endian 32-bit pixels, processed four
+ * at a time.  The results are bit-identical to the generic code, which is
+ * also used for the remaining pixels of a row.
+ */
+
+static void
+util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_sse41(uint8_t *restrict dst, const uint8_t *restrict src, unsigned width)
+{
+   const __m128i swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                         10, 9, 8, 11, 14, 13, 12, 15);
+
+   while (width >= 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+      _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(pixels, swizzle));
+      width -= 4;
+      dst += 4 * 4;
+      src += 4 * 4;
+   }
+   if (width)
+      util_format_b8g8r8a8_unorm_unpack_rgba_8unorm(dst, src, width);
+}
+
+static void
+util_format_b8g8r8x8_unorm_unpack_rgba_8unorm_sse41(uint8_t *restrict dst, const uint8_t *restrict src, unsigned width)
+{
+   const __m128i swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                         10, 9, 8, 11, 14, 13, 12, 15);
+   const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+   while (width >= 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+      pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, swizzle), alpha);
+      _mm_storeu_si128((__m128i *)dst, pixels);
+      width -= 4;
+      dst += 4 * 4;
+      src += 4 * 4;
+   }
+   if (width)
+      util_format_b8g8r8x8_unorm_unpack_rgba_8unorm(dst, src, width);
+}
+
+static void
+util_format_r8g8b8x8_unorm_unpack_rgba_8unorm_sse41(uint8_t *restrict dst, const uint8_t *restrict src, unsigned width)
+{
+   const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+   while (width >= 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+      _mm_storeu_si128((__m128i *)dst, _mm_or_si128(pixels, alpha));
+      width -= 4;
+      dst += 4 * 4;
+      src += 4 * 4;
+   }
+   if (width)
+      util_format_r8g8b8x8_unorm_unpack_rgba_8unorm(dst, src, width);
+}
+
+/**
+ * Convert four 8-bit unorm pixels, already swizzled to RGBA order, to floats.
+ */
+static inline void
+unpack_rgba8_unorm_to_float(float *restrict dst, __m128i pixels)
+{
+   const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+   for (unsigned i = 0; i < 4; i++) {
+      __m128i channels = _mm_cvtepu8_epi32(pixels);
+      _mm_storeu_ps(dst + 4 * i, _mm_mul_ps(_mm_cvtepi32_ps(channels), scale));
+      pixels = _mm_srli_si128(pixels, 4);
+   }
+}
+
+static void
+util_format_r8g8b8a8_unorm_unpack_rgba_float_sse41(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   while (width >= 4) {
+      unpack_rgba8_unorm_to_float(dst, _mm_loadu_si128((const __m128i *)src));
+      width -= 4;
+      dst += 4 * 4;
+      src += 4 * 4;
+   }
+   if (width)
+      util_format_r8g8b8a8_unorm_unpack_rgba_float(dst, src, width);
+}
+
+static void
+util_format_r8g8b8x8_unorm_unpack_rgba_float_sse41(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   const __m128i alpha = _mm_set1_epi32(0xff000000);
+   float *dst = dst_row;
+
+   while (width >= 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+      unpack_rgba8_unorm_to_float(dst, _mm_or_si128(pixels, alpha));
+      width -= 4;
+      dst += 4 * 4;
+      src += 4 * 4;
+   }
+   if (width)
+      util_format_r8g8b8x8_unorm_unpack_rgba_float(dst, src, width);
+}
+
+static void
+util_format_b8g8r8a8_unorm_unpack_rgba_float_sse41(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   const __m128i swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                         10, 9, 8, 11, 14, 13, 12, 15);
+   float *dst = dst_row;
+
+   while (width >= 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+      unpack_rgba8_unorm_to_float(dst, _mm_shuffle_epi8(pixels, swizzle));
+      width -= 4;
+      dst += 4 * 4;
+      src += 4 * 4;
+   }
+   if (width)
+      util_format_b8g8r8a8_unorm_unpack_rgba_float(dst, src, width);
+}
+
+static void
+util_format_b8g8r8x8_unorm_unpack_rgba_float_sse41(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   const __m128i swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                         10, 9, 8, 11, 14, 13, 12, 15);
+   const __m128i alpha = _mm_set1_epi32(0xff000000);
+   float *dst = dst_row;
+
+   while (width >= 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+      pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, swizzle), alpha);
+      unpack_rgba8_unorm_to_float(dst, pixels);
+      width -= 4;
+      dst += 4 * 4;
+      src += 4 * 4;
+   }
+   if (width)
+      util_format_b8g8r8x8_unorm_unpack_rgba_float(dst, src, width);
+}
+
+static void
+util_format_r10g10b10a2_unorm_unpack_rgba_float_sse41(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   const __m128i mask = _mm_set1_epi32(0x3ff);
+   const __m128 scale = _mm_set1_ps(1.0f / 0x3ff);
+   const __m128 scale_a = _mm_set1_ps(1.0f / 0x3);
+   float *dst = dst_row;
+
+   while (width >= 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+      __m128i r = _mm_and_si128(pixels, mask);
+      __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 10), mask);
+      __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 20), mask);
+      __m128i a = _mm_srli_epi32(pixels, 30);
+      __m128 p0 = _mm_mul_ps(_mm_cvtepi32_ps(r), scale);
+      __m128 p1 = _mm_mul_ps(_mm_cvtepi32_ps(g), scale);
+      __m128 p2 = _mm_mul_ps(_mm_cvtepi32_ps(b), scale);
+      __m128 p3 = _mm_mul_ps(_mm_cvtepi32_ps(a), scale_a);
+
+      /* From one channel per register to one pixel per register. */
+      _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+      _mm_storeu_ps(dst + 0, p0);
+      _mm_storeu_ps(dst + 4, p1);
+      _mm_storeu_ps(dst + 8, p2);
+      _mm_storeu_ps(dst + 12, p3);
+      width -= 4;
+      dst += 4 * 4;
+      src += 4 * 4;
+   }
+   if (width)
+      util_format_r10g10b10a2_unorm_unpack_rgba_float(dst, src, width);
+}
+
+static const struct util_format_unpack_description util_format_unpack_descriptions_sse41[] = {
+   [PIPE_FORMAT_R8G8B8A8_UNORM] = {
+      .unpack_rgba_8unorm = &util_format_r8g8b8a8_unorm_unpack_rgba_8unorm,
+      .unpack_rgba = &util_format_r8g8b8a8_unorm_unpack_rgba_float_sse41,
+   },
+   [PIPE_FORMAT_R8G8B8X8_UNORM] = {
+      .unpack_rgba_8unorm = &util_format_r8g8b8x8_unorm_unpack_rgba_8unorm_sse41,
+      .unpack_rgba = &util_format_r8g8b8x8_unorm_unpack_rgba_float_sse41,
+   },
+   [PIPE_FORMAT_B8G8R8A8_UNORM] = {
+      .unpack_rgba_8unorm = &util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_sse41,
+      .unpack_rgba = &util_format_b8g8r8a8_unorm_unpack_rgba_float_sse41,
+   },
+   [PIPE_FORMAT_B8G8R8X8_UNORM] = {
+      .unpack_rgba_8unorm = &util_format_b8g8r8x8_unorm_unpack_rgba_8unorm_sse41,
+      .unpack_rgba = &util_format_b8g8r8x8_unorm_unpack_rgba_float_sse41,
+   },
+   [PIPE_FORMAT_R10G10B10A2_UNORM] = {
+      .unpack_rgba_8unorm = &util_format_r10g10b10a2_unorm_unpack_rgba_8unorm,
+      .unpack_rgba = &util_format_r10g10b10a2_unorm_unpack_rgba_float_sse41,
+   },
+};
+
+const struct util_format_unpack_description *
+util_format_unpack_description_sse41(enum pipe_format format)
+{
+   if (!util_get_cpu_caps()->has_sse4_1)
+      return NULL;
+
+   if (format >= ARRAY_SIZE(util_format_unpack_descriptions_sse41))
+      return NULL;
+
+   if (!util_format_unpack_descriptions_sse41[format].unpack_rgba)
+      return NULL;
+
+   return &util_format_unpack_descriptions_sse41[format];
+}
+
+#endif /* USE_SSE41 */
@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -114,18 +115,106 @@ create_foz_db_filenames(const char *cache_path,
 }
 
 
-/* This looks at stuff that was added to the index since the last time we looked at it. This is safe
- * to do without locking the file as we assume the file is append only */
 static void
-update_foz_index(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx)
+add_foz_index_entry(struct foz_db *foz_db, struct foz_db_entry *entry,
+                    const char *hash, const struct foz_payload_header *header,
+                    uint64_t cache_offset, unsigned file_idx)
 {
-   uint64_t offset = ftell(db_idx);
-   fseek(db_idx, 0, SEEK_END);
-   uint64_t len = ftell(db_idx);
-   uint64_t parsed_offset = offset;
+   char hash_str[FOSSILIZE_BLOB_HASH_LENGTH + 1] = {0};
+   memcpy(hash_str, hash, FOSSILIZE_BLOB_HASH_LENGTH);
 
-   if (offset == len)
-      return;
+   entry->header = *header;
+   entry->file_idx = file_idx;
+   _mesa_sha1_hex_to_sha1(entry->key, hash_str);
+
+   /* Truncate the entry's hash string to a 64bit hash for use with a
+    * 64bit hash table for looking up file offsets.
+    */
+   hash_str[16] = '\0';
+   uint64_t key = strtoull(hash_str, NULL, 16);
+
+   entry->offset = cache_offset;
+
+   _mesa_hash_table_u64_insert(foz_db->index_db, key, entry);
+}
+
+/* Parse the index entries in [offset, len) straight from a read-only
+ * mapping, which avoids going through stdio for every entry. Returns false
+ * if the index can't be mapped.
+ */
+static bool
+parse_foz_index_mapped(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx,
+                       uint64_t offset, uint64_t len, uint64_t *parsed_offset)
+{
+   uint64_t map_offset = offset & ~((uint64_t)sysconf(_SC_PAGESIZE) - 1);
+   size_t map_size = len - map_offset;
+   uint8_t *map = mmap(NULL, map_size, PROT_READ, MAP_SHARED,
+                       fileno(db_idx), map_offset);
+   if (map == MAP_FAILED)
+      return false;
+
+   /* Every complete entry has the same size, so allocate all of them at
+    * once.
+    */
+   const size_t entry_size = FOSSILIZE_BLOB_HASH_LENGTH +
+                             sizeof(struct foz_payload_header) +
+                             sizeof(uint64_t);
+   struct foz_db_entry *entries =
+      ralloc_array(foz_db->mem_ctx, struct foz_db_entry,
+                   MAX2((len - offset) / entry_size, 1));
+   unsigned num_entries = 0;
+
+   *parsed_offset = offset;
+
+   while (entries && offset < len) {
+      const uint8_t *ptr = map + (offset - map_offset);
+      struct foz_payload_header header;
+
+      /* Corrupt entry. Our process might have been killed before we
+       * could write all data.
+       */
+      if (offset + FOSSILIZE_BLOB_HASH_LENGTH + sizeof(header) > len)
+         break;
+
+      /* NAME + HEADER */
+      memcpy(&header, ptr + FOSSILIZE_BLOB_HASH_LENGTH, sizeof(header));
+      offset += FOSSILIZE_BLOB_HASH_LENGTH + sizeof(header);
+
+      /* Corrupt entry. Our process might have been killed before we
+       * could write all data.
+       */
+      if (offset + header.payload_size > len ||
+          header.payload_size != sizeof(uint64_t))
+         break;
+
+      /* cache item offset in the db file */
+      uint64_t cache_offset;
+      memcpy(&cache_offset, ptr + FOSSILIZE_BLOB_HASH_LENGTH + sizeof(header),
+             sizeof(cache_offset));
+
+      offset += header.payload_size;
+      *parsed_offset = offset;
+
+      add_foz_index_entry(foz_db, &entries[num_entries++], (const char *)ptr,
+                          &header, cache_offset, file_idx);
+   }
+
+   munmap(map, map_size);
+
+   if (!num_entries)
+      ralloc_free(entries);
+
+   return true;
+}
+
+/* Parse the index entries in [offset, len) with stdio. Returns the offset
+ * after the last complete entry.
+ */
+static uint64_t
+parse_foz_index_stdio(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx,
+                      uint64_t offset, uint64_t len)
+{
+   uint64_t parsed_offset = offset;
 
    fseek(db_idx, offset, SEEK_SET);
    while (offset < len) {
@@ -153,9 +242,6 @@ update_foz_index(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx)
           header->payload_size != sizeof(uint64_t))
          break;
 
-      char hash_str[FOSSILIZE_BLOB_HASH_LENGTH + 1] = {0};
-      memcpy(hash_str, bytes_to_read, FOSSILIZE_BLOB_HASH_LENGTH);
-
       /* read cache item offset from index file */
       uint64_t cache_offset;
       if (fread(&cache_offset, 1, sizeof(cache_offset), db_idx) !=
@@ -167,21 +253,30 @@ update_foz_index(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx)
 
       struct foz_db_entry *entry = ralloc(foz_db->mem_ctx,
                                           struct foz_db_entry);
-      entry->header = *header;
-      entry->file_idx = file_idx;
-      _mesa_sha1_hex_to_sha1(entry->key, hash_str);
+      add_foz_index_entry(foz_db, entry, bytes_to_read, header, cache_offset,
+                          file_idx);
+   }
 
-      /* Truncate the entry's hash string to a 64bit hash for use with a
-       * 64bit hash table for looking up file offsets.
-       */
-      hash_str[16] = '\0';
-      uint64_t key = strtoull(hash_str, NULL, 16);
+   return parsed_offset;
+}
 
-      entry->offset = cache_offset;
+/* This looks at stuff that was added to the index since the last time we looked at it. This is safe
+ * to do without locking the file as we assume the file is append only */
+static void
+update_foz_index(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx)
+{
+   uint64_t offset = ftell(db_idx);
+   fseek(db_idx, 0, SEEK_END);
+   uint64_t len = ftell(db_idx);
+   uint64_t parsed_offset;
 
-      _mesa_hash_table_u64_insert(foz_db->index_db, key, entry);
-   }
+   if (offset == len)
+      return;
 
+   if (!parse_foz_index_mapped(foz_db, db_idx, file_idx, offset, len,
+                               &parsed_offset))
+      parsed_offset = parse_foz_index_stdio(foz_db, db_idx, file_idx,
+                                            offset, len);
 
    fseek(db_idx, parsed_offset, SEEK_SET);
 }
@@ -145,6 +145,55 @@ entry_is_present(const struct hash_table *ht, struct hash_entry *entry)
    return entry->key != NULL && entry->key != ht->deleted_key;
 }
 
+static inline uint32_t
+hash_pointer(const void *pointer)
+{
+   uintptr_t num = (uintptr_t) pointer;
+   return (uint32_t) ((num >> 2) ^ (num >> 6) ^ (num >> 10) ^ (num >> 14));
+}
+
+static uint32_t
+key_u32_hash(const void *key)
+{
+   uint32_t u = (uint32_t)(uintptr_t)key;
+   return _mesa_hash_uint(&u);
+}
+
+static bool
+key_u32_equals(const void *a, const void *b)
+{
+   return (uint32_t)(uintptr_t)a == (uint32_t)(uintptr_t)b;
+}
+
+/* Pointer and u32 keys are by far the most common, so hash and compare them
+ * inline instead of calling through the function pointers.
+ */
+static inline uint32_t
+key_hash(const struct hash_table *ht, const void *key)
+{
+   if (ht->key_hash_function == _mesa_hash_pointer)
+      return hash_pointer(key);
+   if (ht->key_hash_function == _mesa_hash_u32)
+      return XXH32(key, 4, 0);
+   if (ht->key_hash_function == key_u32_hash) {
+      uint32_t u = (uint32_t)(uintptr_t)key;
+      return XXH32(&u, 4, 0);
+   }
+   return ht->key_hash_function(key);
+}
+
+static inline bool
+key_equals(const struct hash_table *ht, const void *a, const void *b)
+{
+   if (ht->key_equals_function == _mesa_key_pointer_equal)
+      return a == b;
+   if (ht->key_equals_function == _mesa_key_u32_equal)
+      return *(const uint32_t *)a == *(const uint32_t *)b;
+   if (ht->key_equals_function == key_u32_equals)
+      return (uint32_t)(uintptr_t)a == (uint32_t)(uintptr_t)b;
+   return ht->key_equals_function(a, b);
+}
+
 bool
 _mesa_hash_table_init(struct hash_table *ht,
                       void *mem_ctx,
@@ -191,19 +240,6 @@ _mesa_hash_table_create(void *mem_ctx,
    return ht;
 }
 
-static uint32_t
-key_u32_hash(const void *key)
-{
-   uint32_t u = (uint32_t)(uintptr_t)key;
-   return _mesa_hash_uint(&u);
-}
-
-static bool
-key_u32_equals(const void *a, const void *b)
-{
-   return (uint32_t)(uintptr_t)a == (uint32_t)(uintptr_t)b;
-}
-
 /* key == 0 and key == deleted_key are not allowed */
 struct hash_table *
 _mesa_hash_table_create_u32_keys(void *mem_ctx)
@@ -322,7 +358,7 @@ hash_table_search(struct hash_table *ht, uint32_t hash, const void *key)
       if (entry_is_free(entry)) {
          return NULL;
       } else if (entry_is_present(ht, entry) && entry->hash == hash) {
-         if (ht->key_equals_function(key, entry->key)) {
+         if (key_equals(ht, key, entry->key)) {
             return entry;
          }
       }
@@ -345,7 +381,7 @@ struct hash_entry *
 _mesa_hash_table_search(struct hash_table *ht, const void *key)
 {
    assert(ht->key_hash_function);
-   return hash_table_search(ht, ht->key_hash_function(key), key);
+   return hash_table_search(ht, key_hash(ht, key), key);
 }
 
 struct hash_entry *
@@ -469,7 +505,7 @@ hash_table_insert(struct hash_table *ht, uint32_t hash,
        */
       if (!entry_is_deleted(ht, entry) &&
           entry->hash == hash &&
-          ht->key_equals_function(key, entry->key)) {
+          key_equals(ht, key, entry->key)) {
          entry->key = key;
          entry->data = data;
          return entry;
@@ -506,7 +542,7 @@ struct hash_entry *
 _mesa_hash_table_insert(struct hash_table *ht, const void *key, void *data)
 {
    assert(ht->key_hash_function);
-   return hash_table_insert(ht, ht->key_hash_function(key), key, data);
+   return hash_table_insert(ht, key_hash(ht, key), key, data);
 }
 
 struct hash_entry *
@@ -678,8 +714,7 @@ _mesa_hash_string_with_length(const void *_key, unsigned length)
 uint32_t
 _mesa_hash_pointer(const void *pointer)
 {
-   uintptr_t num = (uintptr_t) pointer;
-   return (uint32_t) ((num >> 2) ^ (num >> 6) ^ (num >> 10) ^ (num >> 14));
+   return hash_pointer(pointer);
 }
 
 bool
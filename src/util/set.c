@@ -42,6 +42,9 @@
 #include "set.h"
 #include "fast_urem_by_const.h"
 
+#define XXH_INLINE_ALL
+#include "xxhash.h"
+
 /*
  * From Knuth -- a good choice for hash/rehash values is p, p-2 where
  * p and p-2 are both prime.  These tables are sized to have an extra 10%
@@ -116,6 +119,53 @@ entry_is_present(struct set_entry *entry)
    return entry->key != NULL && entry->key != deleted_key;
 }
 
+static inline uint32_t
+hash_pointer(const void *pointer)
+{
+   uintptr_t num = (uintptr_t) pointer;
+   return (uint32_t) ((num >> 2) ^ (num >> 6) ^ (num >> 10) ^ (num >> 14));
+}
+
+static uint32_t
+key_u32_hash(const void *key)
+{
+   uint32_t u = (uint32_t)(uintptr_t)key;
+   return _mesa_hash_uint(&u);
+}
+
+static bool
+key_u32_equals(const void *a, const void *b)
+{
+   return (uint32_t)(uintptr_t)a == (uint32_t)(uintptr_t)b;
+}
+
+/* As in hash_table.c, avoid the indirect calls for the common key types. */
+static inline uint32_t
+key_hash(const struct set *ht, const void *key)
+{
+   if (ht->key_hash_function == _mesa_hash_pointer)
+      return hash_pointer(key);
+   if (ht->key_hash_function == _mesa_hash_u32)
+      return XXH32(key, 4, 0);
+   if (ht->key_hash_function == key_u32_hash) {
+      uint32_t u = (uint32_t)(uintptr_t)key;
+      return XXH32(&u, 4, 0);
+   }
+   return ht->key_hash_function(key);
+}
+
+static inline bool
+key_equals(const struct set *ht, const void *a, const void *b)
+{
+   if (ht->key_equals_function == _mesa_key_pointer_equal)
+      return a == b;
+   if (ht->key_equals_function == _mesa_key_u32_equal)
+      return *(const uint32_t *)a == *(const uint32_t *)b;
+   if (ht->key_equals_function == key_u32_equals)
+      return (uint32_t)(uintptr_t)a == (uint32_t)(uintptr_t)b;
+   return ht->key_equals_function(a, b);
+}
+
 bool
 _mesa_set_init(struct set *ht, void *mem_ctx,
                  uint32_t (*key_hash_function)(const void *key),
@@ -157,19 +207,6 @@ _mesa_set_create(void *mem_ctx,
    return ht;
 }
 
-static uint32_t
-key_u32_hash(const void *key)
-{
-   uint32_t u = (uint32_t)(uintptr_t)key;
-   return _mesa_hash_uint(&u);
-}
-
-static bool
-key_u32_equals(const void *a, const void *b)
-{
-   return (uint32_t)(uintptr_t)a == (uint32_t)(uintptr_t)b;
-}
-
 /* key == 0 and key == deleted_key are not allowed */
 struct set *
 _mesa_set_create_u32_keys(void *mem_ctx)
@@ -276,7 +313,7 @@ set_search(const struct set *ht, uint32_t hash, const void *key)
       if (entry_is_free(entry)) {
          return NULL;
       } else if (entry_is_present(entry) && entry->hash == hash) {
-         if (ht->key_equals_function(key, entry->key)) {
+         if (key_equals(ht, key, entry->key)) {
             return entry;
          }
       }
@@ -293,7 +330,7 @@ struct set_entry *
 _mesa_set_search(const struct set *set, const void *key)
 {
    assert(set->key_hash_function);
-   return set_search(set, set->key_hash_function(key), key);
+   return set_search(set, key_hash(set, key), key);
 }
 
 struct set_entry *
@@ -420,7 +457,7 @@ set_search_or_add(struct set *ht, uint32_t hash, const void *key, bool *found)
 
       if (!entry_is_deleted(entry) &&
           entry->hash == hash &&
-          ht->key_equals_function(key, entry->key)) {
+          key_equals(ht, key, entry->key)) {
          if (found)
             *found = true;
          return entry;
@@ -480,7 +517,7 @@ struct set_entry *
 _mesa_set_add(struct set *set, const void *key)
 {
    assert(set->key_hash_function);
-   return set_add(set, set->key_hash_function(key), key);
+   return set_add(set, key_hash(set, key), key);
 }
 
 struct set_entry *
@@ -496,7 +533,7 @@ _mesa_set_search_and_add(struct set *set, const void *key, bool *replaced)
 {
    assert(set->key_hash_function);
    return _mesa_set_search_and_add_pre_hashed(set,
-                                              set->key_hash_function(key),
+                                              key_hash(set, key),
                                               key, replaced);
 }
 
@@ -522,7 +559,7 @@ struct set_entry *
 _mesa_set_search_or_add(struct set *set, const void *key, bool *found)
 {
    assert(set->key_hash_function);
-   return set_search_or_add(set, set->key_hash_function(key), key, found);
+   return set_search_or_add(set, key_hash(set, key), key, found);
 }
 
 struct set_entry *
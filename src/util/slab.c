@@ -24,6 +24,7 @@
 #include "slab.h"
 #include "macros.h"
 #include "u_atomic.h"
+#include "c11/threads.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
@@ -95,6 +96,21 @@ slab_free_orphaned(struct slab_element_header *elt)
       free(page);
 }
 
+/* Take all elements that other pools have freed into this one.  Only the
+ * owner pops from the list, so this is not subject to ABA.
+ */
+static struct slab_element_header *
+slab_take_migrated(struct slab_child_pool *pool)
+{
+   struct slab_element_header *list;
+
+   do {
+      list = p_atomic_read(&pool->migrated);
+   } while (list && p_atomic_cmpxchg_ptr(&pool->migrated, list, NULL) != list);
+
+   return list;
+}
+
 /**
  * Create a parent pool for the allocation of same-sized objects.
  *
@@ -106,7 +122,7 @@ slab_create_parent(struct slab_parent_pool *parent,
                    unsigned item_size,
                    unsigned num_items)
 {
-   simple_mtx_init(&parent->mutex, mtx_plain);
+   parent->migrating = 0;
    parent->element_size = ALIGN_POT(sizeof(struct slab_element_header) + item_size,
                                     sizeof(intptr_t));
    parent->num_elements = num_items;
@@ -116,7 +132,7 @@ slab_create_parent(struct slab_parent_pool *parent,
 void
 slab_destroy_parent(struct slab_parent_pool *parent)
 {
-   simple_mtx_destroy(&parent->mutex);
+   assert(!parent->migrating);
 }
 
 /**
@@ -142,8 +158,6 @@ void slab_destroy_child(struct slab_child_pool *pool)
    if (!pool->parent)
       return; /* the slab probably wasn't even created */
 
-   simple_mtx_lock(&pool->parent->mutex);
-
    while (pool->pages) {
       struct slab_page_header *page = pool->pages;
       pool->pages = page->u.next;
@@ -155,14 +169,21 @@ void slab_destroy_child(struct slab_child_pool *pool)
       }
    }
 
-   while (pool->migrated) {
-      struct slab_element_header *elt = pool->migrated;
-      pool->migrated = elt->next;
+   /* A slab_free in another thread may have seen this pool as the owner
+    * before the pages were orphaned.  Wait until it has pushed the element
+    * to our migrated list.  This must be a read-modify-write, so that either
+    * we see its increment or it sees the orphaned owner.
+    */
+   while (p_atomic_add_return(&pool->parent->migrating, 0))
+      thrd_yield();
+
+   struct slab_element_header *migrated = slab_take_migrated(pool);
+   while (migrated) {
+      struct slab_element_header *elt = migrated;
+      migrated = elt->next;
       slab_free_orphaned(elt);
    }
 
-   simple_mtx_unlock(&pool->parent->mutex);
-
    while (pool->free) {
       struct slab_element_header *elt = pool->free;
       pool->free = elt->next;
@@ -212,10 +233,7 @@ slab_alloc(struct slab_child_pool *pool)
       /* First, collect elements that belong to us but were freed from a
        * different child pool.
        */
-      simple_mtx_lock(&pool->parent->mutex);
-      pool->free = pool->migrated;
-      pool->migrated = NULL;
-      simple_mtx_unlock(&pool->parent->mutex);
+      pool->free = slab_take_migrated(pool);
 
       /* Now allocate a new page. */
       if (!pool->free && !slab_add_new_page(pool))
@@ -271,7 +289,7 @@ void slab_free(struct slab_child_pool *pool, void *ptr)
 
    /* The slow case: migration or an orphaned page. */
    if (pool->parent)
-      simple_mtx_lock(&pool->parent->mutex);
+      p_atomic_inc(&pool->parent->migrating);
 
    /* Note: we _must_ re-read elt->owner here because the owning child pool
     * may have been destroyed by another thread in the meantime.
@@ -280,13 +298,18 @@ void slab_free(struct slab_child_pool *pool, void *ptr)
 
    if (!(owner_int & 1)) {
       struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
-      elt->next = owner->migrated;
-      owner->migrated = elt;
+      struct slab_element_header *next;
+
+      do {
+         next = p_atomic_read(&owner->migrated);
+         elt->next = next;
+      } while (p_atomic_cmpxchg_ptr(&owner->migrated, next, elt) != next);
+
       if (pool->parent)
-         simple_mtx_unlock(&pool->parent->mutex);
+         p_atomic_dec(&pool->parent->migrating);
    } else {
       if (pool->parent)
-         simple_mtx_unlock(&pool->parent->mutex);
+         p_atomic_dec(&pool->parent->migrating);
 
       slab_free_orphaned(elt);
    }
@@ -32,8 +32,9 @@
  *
  * Allocations obtained from one child pool should usually be freed in the
  * same child pool. Freeing an allocation in a different child pool associated
- * to the same parent is allowed (and requires no locking by the caller), but
- * it is discouraged because it implies a performance penalty.
+ * to the same parent is allowed (and requires no locking by the caller). Such
+ * elements are handed back to their owner through a lock-free list, which is
+ * slower than a local free but never blocks.
  *
  * For convenience and to ease the transition, there is also a set of wrapper
  * functions around a single parent-child pair.
@@ -52,7 +53,10 @@ struct slab_element_header;
 struct slab_page_header;
 
 struct slab_parent_pool {
-   simple_mtx_t mutex;
+   /* Number of slab_free calls currently handing an element to another
+    * child pool.  slab_destroy_child waits for this to drop to zero.
+    */
+   unsigned migrating;
    unsigned element_size;
    unsigned num_elements;
    unsigned item_size;
@@ -69,7 +73,8 @@ struct slab_child_pool {
    /* Elements that are owned by this pool but were freed with a different
     * pool as the argument to slab_free.
     *
-    * This list is protected by the parent mutex.
+    * Other pools push to this list atomically, the owner takes the whole
+    * list at once.
     */
    struct slab_element_header *migrated;
 };
@@ -28,6 +28,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <float.h>
 
 #include "util/half_float.h"
@@ -35,6 +36,7 @@
 #include "util/format/u_format.h"
 #include "util/format/u_format_tests.h"
 #include "util/format/u_format_s3tc.h"
+#include "util/os_time.h"
 
 
 static bool
@@ -865,11 +867,149 @@ test_all(void)
 }
 
 
+/* Row width for the optimized unpack tests: not a multiple of the SIMD width,
+ * so the scalar tail is exercised too.
+ */
+#define UNPACK_ROW_WIDTH 67
+
+static void
+fill_random(uint8_t *data, unsigned size)
+{
+   uint32_t seed = 0x12345678;
+
+   for (unsigned i = 0; i < size; i++) {
+      seed = seed * 1103515245 + 12345;
+      data[i] = seed >> 16;
+   }
+}
+
+/**
+ * Check the CPU-specific unpack paths (if any) against the generic ones over
+ * a whole row of pixels.
+ */
+static bool
+test_optimized_unpack(void)
+{
+   uint8_t src[UNPACK_ROW_WIDTH * UTIL_FORMAT_MAX_PACKED_BYTES];
+   uint8_t generic[UNPACK_ROW_WIDTH * 4 * sizeof(float)];
+   uint8_t optimized[UNPACK_ROW_WIDTH * 4 * sizeof(float)];
+   enum pipe_format format;
+   bool success = true;
+
+   fill_random(src, sizeof(src));
+
+   for (format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_unpack_description *unpack =
+         util_format_unpack_description(format);
+      const struct util_format_unpack_description *unpack_generic =
+         util_format_unpack_description_generic(format);
+
+      if (!unpack || unpack == unpack_generic)
+         continue;
+
+      printf("Testing util_format_%s_unpack optimized rows ...\n",
+             util_format_short_name(format));
+      fflush(stdout);
+
+      if (unpack->unpack_rgba && unpack_generic->unpack_rgba) {
+         memset(generic, 0, sizeof(generic));
+         memset(optimized, 0xff, sizeof(optimized));
+         unpack_generic->unpack_rgba(generic, src, UNPACK_ROW_WIDTH);
+         unpack->unpack_rgba(optimized, src, UNPACK_ROW_WIDTH);
+         if (memcmp(generic, optimized, UNPACK_ROW_WIDTH * 4 * sizeof(float))) {
+            printf("FAILED: unpack_rgba mismatch\n");
+            success = false;
+         }
+      }
+
+      if (unpack->unpack_rgba_8unorm && unpack_generic->unpack_rgba_8unorm) {
+         memset(generic, 0, sizeof(generic));
+         memset(optimized, 0xff, sizeof(optimized));
+         unpack_generic->unpack_rgba_8unorm(generic, src, UNPACK_ROW_WIDTH);
+         unpack->unpack_rgba_8unorm(optimized, src, UNPACK_ROW_WIDTH);
+         if (memcmp(generic, optimized, UNPACK_ROW_WIDTH * 4)) {
+            printf("FAILED: unpack_rgba_8unorm mismatch\n");
+            success = false;
+         }
+      }
+   }
+
+   return success;
+}
+
+static double
+benchmark_unpack_row(const struct util_format_unpack_description *unpack,
+                     bool unorm8, void *dst, const uint8_t *src, unsigned width)
+{
+   const unsigned iterations = 20000;
+   int64_t start = os_time_get_nano();
+
+   for (unsigned i = 0; i < iterations; i++) {
+      if (unorm8)
+         unpack->unpack_rgba_8unorm(dst, src, width);
+      else
+         unpack->unpack_rgba(dst, src, width);
+   }
+
+   int64_t elapsed = os_time_get_nano() - start;
+   return (double)iterations * width / MAX2(elapsed, 1) * 1000.0;
+}
+
+/**
+ * Print the unpack throughput of the generic and the optimized paths for the
+ * formats that have the latter.  Only run when asked for with --benchmark.
+ */
+static void
+benchmark_optimized_unpack(void)
+{
+   const unsigned width = 1024;
+   uint8_t *src = malloc(width * UTIL_FORMAT_MAX_PACKED_BYTES);
+   float *dst = malloc(width * 4 * sizeof(float));
+   enum pipe_format format;
+
+   fill_random(src, width * UTIL_FORMAT_MAX_PACKED_BYTES);
+
+   for (format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_unpack_description *unpack =
+         util_format_unpack_description(format);
+      const struct util_format_unpack_description *unpack_generic =
+         util_format_unpack_description_generic(format);
+
+      if (!unpack || unpack == unpack_generic)
+         continue;
+
+      if (unpack->unpack_rgba) {
+         printf("%-24s unpack_rgba:        generic %8.1f Mpix/s, optimized %8.1f Mpix/s\n",
+                util_format_short_name(format),
+                benchmark_unpack_row(unpack_generic, false, dst, src, width),
+                benchmark_unpack_row(unpack, false, dst, src, width));
+      }
+      if (unpack->unpack_rgba_8unorm) {
+         printf("%-24s unpack_rgba_8unorm: generic %8.1f Mpix/s, optimized %8.1f Mpix/s\n",
+                util_format_short_name(format),
+                benchmark_unpack_row(unpack_generic, true, dst, src, width),
+                benchmark_unpack_row(unpack, true, dst, src, width));
+      }
+   }
+
+   free(src);
+   free(dst);
+}
+
+
 int main(int argc, char **argv)
 {
    bool success;
 
+   if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+      benchmark_optimized_unpack();
+      return 0;
+   }
+
    success = test_all();
 
+   if (!test_optimized_unpack())
+      success = false;
+
    return success ? 0 : 1;
 }
@@ -0,0 +1,104 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Not a test: measures insert, search and iterate throughput of pointer and
+ * u32 keyed tables.  The "callback" rows use key functions equivalent to the
+ * stock ones, which forces the generic indirect-call path, for comparison
+ * with the inlined fast path.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "util/hash_table.h"
+#include "util/os_time.h"
+
+#define SIZE (1 << 16)
+#define ROUNDS 32
+
+static uint32_t
+callback_hash_pointer(const void *key)
+{
+   return _mesa_hash_pointer(key);
+}
+
+static bool
+callback_key_pointer_equal(const void *a, const void *b)
+{
+   return a == b;
+}
+
+static uint32_t
+callback_hash_u32(const void *key)
+{
+   return _mesa_hash_u32(key);
+}
+
+static bool
+callback_key_u32_equal(const void *a, const void *b)
+{
+   return *(const uint32_t *)a == *(const uint32_t *)b;
+}
+
+static double
+mops(int64_t start, unsigned ops)
+{
+   return ops / ((os_time_get_nano() - start) / 1000.0);
+}
+
+static void
+run(const char *name, const uint32_t *keys,
+    uint32_t (*key_hash_function)(const void *key),
+    bool (*key_equals_function)(const void *a, const void *b))
+{
+   double insert = 0, search = 0, iterate = 0;
+   uintptr_t sum = 0;
+
+   for (unsigned r = 0; r < ROUNDS; r++) {
+      struct hash_table *ht =
+         _mesa_hash_table_create(NULL, key_hash_function, key_equals_function);
+
+      int64_t start = os_time_get_nano();
+      for (unsigned i = 0; i < SIZE; i++)
+         _mesa_hash_table_insert(ht, keys + i, NULL);
+      insert += mops(start, SIZE);
+
+      start = os_time_get_nano();
+      for (unsigned i = 0; i < SIZE; i++)
+         sum += (uintptr_t)_mesa_hash_table_search(ht, keys + i);
+      search += mops(start, SIZE);
+
+      start = os_time_get_nano();
+      hash_table_foreach(ht, entry)
+         sum += (uintptr_t)entry->key;
+      iterate += mops(start, SIZE);
+
+      _mesa_hash_table_destroy(ht, NULL);
+   }
+
+   printf("%-20s insert %7.1f  search %7.1f  iterate %7.1f Mops/s (%u)\n",
+          name, insert / ROUNDS, search / ROUNDS, iterate / ROUNDS,
+          (unsigned)(sum & 1));
+}
+
+int
+main(int argc, char **argv)
+{
+   uint32_t *keys = malloc(SIZE * sizeof(*keys));
+
+   (void) argc;
+   (void) argv;
+
+   for (unsigned i = 0; i < SIZE; i++)
+      keys[i] = i * 2654435761u;
+
+   run("pointer", keys, _mesa_hash_pointer, _mesa_key_pointer_equal);
+   run("pointer (callback)", keys, callback_hash_pointer,
+       callback_key_pointer_equal);
+   run("u32", keys, _mesa_hash_u32, _mesa_key_u32_equal);
+   run("u32 (callback)", keys, callback_hash_u32, callback_key_u32_equal);
+
+   free(keys);
+
+   return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+
+#undef NDEBUG
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "util/hash_table.h"
+
+#define SIZE 1000
+
+/* Keys that compare equal by value but live at different addresses, to make
+ * sure u32 keys are never compared as pointers.
+ */
+int
+main(int argc, char **argv)
+{
+   struct hash_table *ht;
+   struct hash_entry *entry;
+   uint32_t keys[SIZE], copies[SIZE];
+   uint32_t i;
+
+   (void) argc;
+   (void) argv;
+
+   ht = _mesa_hash_table_create(NULL, _mesa_hash_u32, _mesa_key_u32_equal);
+
+   for (i = 0; i < SIZE; i++) {
+      keys[i] = i * 7919;
+      copies[i] = keys[i];
+      _mesa_hash_table_insert(ht, keys + i, keys + i);
+   }
+   assert(ht->entries == SIZE);
+
+   for (i = 0; i < SIZE; i++) {
+      entry = _mesa_hash_table_search(ht, copies + i);
+      assert(entry);
+      assert(entry->data == keys + i);
+   }
+
+   /* Replacement through an equal key at another address. */
+   _mesa_hash_table_insert(ht, copies, copies);
+   assert(ht->entries == SIZE);
+   entry = _mesa_hash_table_search(ht, keys);
+   assert(entry && entry->data == copies);
+
+   for (i = 0; i < SIZE; i += 2)
+      _mesa_hash_table_remove_key(ht, copies + i);
+   assert(ht->entries == SIZE / 2);
+
+   for (i = 0; i < SIZE; i++) {
+      entry = _mesa_hash_table_search(ht, keys + i);
+      assert((entry != NULL) == (i % 2 == 1));
+   }
+
+   _mesa_hash_table_destroy(ht, NULL);
+
+   return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Testing u_queue.h job priorities
+ */
+
+#include <gtest/gtest.h>
+
+#include "util/u_atomic.h"
+#include "util/u_queue.h"
+
+struct queue_test_job {
+   struct util_queue_fence fence;
+   unsigned id;
+   unsigned *order;
+   unsigned *num_executed;
+};
+
+static void
+record_job(void *data, void *gdata, int thread_index)
+{
+   struct queue_test_job *job = (struct queue_test_job *)data;
+
+   job->order[(*job->num_executed)++] = job->id;
+}
+
+struct blocking_job_data {
+   struct util_queue_fence started;
+   struct util_queue_fence release;
+};
+
+static void
+blocking_job(void *data, void *gdata, int thread_index)
+{
+   struct blocking_job_data *blocking = (struct blocking_job_data *)data;
+
+   util_queue_fence_signal(&blocking->started);
+   util_queue_fence_wait(&blocking->release);
+}
+
+class UtilQueue : public ::testing::Test {
+protected:
+   void SetUp() override
+   {
+      ASSERT_TRUE(util_queue_init(&queue, "test", 16, 1, 0, NULL));
+
+      /* Keep the only thread busy so that the jobs added by the test stay
+       * queued until the blocking job is released.
+       */
+      util_queue_fence_init(&blocking.started);
+      util_queue_fence_reset(&blocking.started);
+      util_queue_fence_init(&blocking.release);
+      util_queue_fence_reset(&blocking.release);
+      util_queue_fence_init(&blocker);
+      start_time = os_time_get_nano();
+      util_queue_add_job(&queue, &blocking, &blocker, blocking_job, NULL, 0);
+      util_queue_fence_wait(&blocking.started);
+   }
+
+   void TearDown() override
+   {
+      util_queue_destroy(&queue);
+      util_queue_fence_destroy(&blocker);
+      util_queue_fence_destroy(&blocking.release);
+      util_queue_fence_destroy(&blocking.started);
+   }
+
+   void add(struct queue_test_job *job, unsigned id,
+            enum util_queue_job_priority priority)
+   {
+      util_queue_fence_init(&job->fence);
+      job->id = id;
+      job->order = order;
+      job->num_executed = &num_executed;
+      util_queue_add_job_with_priority(&queue, job, &job->fence, record_job,
+                                       NULL, 0, priority);
+   }
+
+   void run()
+   {
+      util_queue_fence_signal(&blocking.release);
+      util_queue_finish(&queue);
+   }
+
+   struct util_queue queue;
+   struct blocking_job_data blocking;
+   struct util_queue_fence blocker;
+   int64_t start_time;
+   unsigned order[16] = {};
+   unsigned num_executed = 0;
+};
+
+TEST_F(UtilQueue, Priorities)
+{
+   struct queue_test_job jobs[6];
+
+   add(&jobs[0], 0, UTIL_QUEUE_JOB_PRIORITY_LOW);
+   add(&jobs[1], 1, UTIL_QUEUE_JOB_PRIORITY_NORMAL);
+   add(&jobs[2], 2, UTIL_QUEUE_JOB_PRIORITY_LOW);
+   add(&jobs[3], 3, UTIL_QUEUE_JOB_PRIORITY_HIGH);
+   add(&jobs[4], 4, UTIL_QUEUE_JOB_PRIORITY_NORMAL);
+   add(&jobs[5], 5, UTIL_QUEUE_JOB_PRIORITY_HIGH);
+   run();
+
+   const unsigned expected[] = { 3, 5, 1, 4, 0, 2 };
+   ASSERT_EQ(num_executed, ARRAY_SIZE(expected));
+   for (unsigned i = 0; i < ARRAY_SIZE(expected); i++)
+      EXPECT_EQ(order[i], expected[i]);
+
+   for (unsigned i = 0; i < ARRAY_SIZE(jobs); i++)
+      util_queue_fence_destroy(&jobs[i].fence);
+}
+
+TEST_F(UtilQueue, Promote)
+{
+   struct queue_test_job jobs[4];
+
+   add(&jobs[0], 0, UTIL_QUEUE_JOB_PRIORITY_NORMAL);
+   add(&jobs[1], 1, UTIL_QUEUE_JOB_PRIORITY_HIGH);
+   add(&jobs[2], 2, UTIL_QUEUE_JOB_PRIORITY_LOW);
+   add(&jobs[3], 3, UTIL_QUEUE_JOB_PRIORITY_LOW);
+
+   EXPECT_TRUE(util_queue_promote_job(&queue, &jobs[2].fence));
+   /* The blocking job is already executing. */
+   EXPECT_FALSE(util_queue_promote_job(&queue, &blocker));
+
+   /* A job added later at the highest priority doesn't overtake it. */
+   struct queue_test_job late;
+   add(&late, 4, UTIL_QUEUE_JOB_PRIORITY_HIGH);
+   run();
+
+   EXPECT_FALSE(util_queue_promote_job(&queue, &jobs[3].fence));
+
+   const unsigned expected[] = { 2, 1, 4, 0, 3 };
+   ASSERT_EQ(num_executed, ARRAY_SIZE(expected));
+   for (unsigned i = 0; i < ARRAY_SIZE(expected); i++)
+      EXPECT_EQ(order[i], expected[i]);
+
+   for (unsigned i = 0; i < ARRAY_SIZE(jobs); i++)
+      util_queue_fence_destroy(&jobs[i].fence);
+   util_queue_fence_destroy(&late.fence);
+}
+
+TEST_F(UtilQueue, BusyTime)
+{
+   /* The blocking job runs until it is released. */
+   os_time_sleep(1000);
+   run();
+
+   EXPECT_GE(util_queue_get_busy_time_nano(&queue), 1000000);
+   EXPECT_LE(util_queue_get_busy_time_nano(&queue),
+             os_time_get_nano() - start_time);
+}
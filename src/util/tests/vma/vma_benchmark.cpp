@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Not a test: measures allocation throughput and fragmentation of the VMA
+ * heap under random churn, for each of the allocation policies.
+ *
+ * The heap is kept close to full so that it fragments.  A failed allocation
+ * counts as a fragmentation failure when the heap still had enough free
+ * space in total to satisfy it.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "util/os_time.h"
+#include "util/vma.h"
+
+namespace {
+
+static const uint64_t MEM_PAGE_SIZE = 4096;
+static const uint64_t HEAP_START = 1ull << 32;
+static const uint64_t HEAP_SIZE = 1ull << 30;
+static const unsigned OPS = 1000000;
+
+struct allocation {
+   uint64_t addr;
+   uint64_t size;
+};
+
+static uint64_t
+largest_free_block(struct util_vma_heap *heap)
+{
+   uint64_t largest = 0;
+
+   for (uint64_t size = HEAP_SIZE; size >= MEM_PAGE_SIZE; size /= 2) {
+      uint64_t addr = util_vma_heap_alloc(heap, size, MEM_PAGE_SIZE);
+      if (addr) {
+         util_vma_heap_free(heap, addr, size);
+         largest = size;
+         break;
+      }
+   }
+
+   return largest;
+}
+
+static void
+run(const char *name, bool alloc_high, bool best_fit)
+{
+   std::default_random_engine rand{8675309};
+   /* Sizes from 4KiB to 8MiB, with small buffers being the most common */
+   std::geometric_distribution<> size_order(0.3);
+   std::uniform_int_distribution<> percent(0, 99);
+   std::vector<allocation> allocations;
+
+   struct util_vma_heap heap;
+   util_vma_heap_init(&heap, HEAP_START, HEAP_SIZE);
+   heap.alloc_high = alloc_high;
+   heap.best_fit = best_fit;
+
+   unsigned allocs = 0, frees = 0, failures = 0;
+   int64_t start = os_time_get_nano();
+
+   for (unsigned i = 0; i < OPS; i++) {
+      /* Free more often once the heap is 97% full */
+      bool full = heap.free_size < HEAP_SIZE / 32;
+      if (!allocations.empty() && percent(rand) < (full ? 55 : 45)) {
+         std::uniform_int_distribution<size_t> pick(0, allocations.size() - 1);
+         size_t idx = pick(rand);
+         util_vma_heap_free(&heap, allocations[idx].addr,
+                            allocations[idx].size);
+         allocations[idx] = allocations.back();
+         allocations.pop_back();
+         frees++;
+         continue;
+      }
+
+      uint64_t size = MEM_PAGE_SIZE << std::min(size_order(rand), 11);
+      uint64_t align = percent(rand) < 10 ? 64 * 1024 : MEM_PAGE_SIZE;
+      uint64_t addr = util_vma_heap_alloc(&heap, size, align);
+      if (addr) {
+         allocations.push_back(allocation{addr, size});
+         allocs++;
+      } else if (heap.free_size >= size) {
+         failures++;
+      }
+   }
+
+   double usec = (os_time_get_nano() - start) / 1000.0;
+
+   printf("%-16s %6.2f Mops/s  %8u allocs  %8u frees  %6u failures  "
+          "%5.1f%% used  largest free %6" PRIu64 " KiB\n",
+          name, (allocs + frees) / usec, allocs, frees, failures,
+          100.0 * (HEAP_SIZE - heap.free_size) / HEAP_SIZE,
+          largest_free_block(&heap) / 1024);
+
+   util_vma_heap_finish(&heap);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+   (void) argc;
+   (void) argv;
+
+   run("first-fit high", true, false);
+   run("first-fit low", false, false);
+   run("best-fit high", true, true);
+   run("best-fit low", false, true);
+
+   return 0;
+}
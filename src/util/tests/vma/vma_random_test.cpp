@@ -72,10 +72,11 @@ struct random_test {
    static const uint64_t MEM_SIZE = 0xfffffffffffff000;
    static const uint64_t MEM_PAGES = MEM_SIZE / MEM_PAGE_SIZE;
 
-   random_test(uint_fast32_t seed)
+   random_test(uint_fast32_t seed, bool best_fit)
       : heap_holes{allocation{MEM_START_PAGE, MEM_PAGES}}, rand{seed}
    {
       util_vma_heap_init(&heap, MEM_START_PAGE * MEM_PAGE_SIZE, MEM_SIZE);
+      heap.best_fit = best_fit;
    }
 
    ~random_test()
@@ -249,9 +250,12 @@ int main(int argc, char **argv)
       errx(1, "USAGE: %s seed iter_count\n", argv[0]);
    }
 
-   random_test r{(uint_fast32_t)seed};
+   random_test r{(uint_fast32_t)seed, false};
    r.test(count);
 
+   random_test best_fit{(uint_fast32_t)seed, true};
+   best_fit.test(count);
+
    printf("ok\n");
    return 0;
 }
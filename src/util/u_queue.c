@@ -29,6 +29,7 @@
 #include "c11/threads.h"
 #include "util/u_cpu_detect.h"
 #include "util/os_time.h"
+#include "util/u_debug.h"
 #include "util/u_string.h"
 #include "util/u_thread.h"
 #include "u_process.h"
@@ -237,6 +238,29 @@ util_queue_fence_destroy(struct util_queue_fence *fence)
 }
 #endif
 
+/****************************************************************************
+ * Process-wide thread budget
+ *
+ * Every component creates its own queues, and each queue adds threads on
+ * demand up to its own limit, so a process using several drivers can end up
+ * with far more threads than cores. If MESA_QUEUE_THREAD_BUDGET is set,
+ * queues only add threads on demand while the total number of util_queue
+ * threads in the process is below it. Each queue always keeps its first
+ * thread, so this never stalls a queue.
+ */
+
+DEBUG_GET_ONCE_NUM_OPTION(queue_thread_budget, "MESA_QUEUE_THREAD_BUDGET", 0)
+
+static unsigned queue_threads_total;
+
+static bool
+util_queue_thread_budget_available(void)
+{
+   int64_t budget = debug_get_option_queue_thread_budget();
+
+   return budget <= 0 || p_atomic_read(&queue_threads_total) < budget;
+}
+
 /****************************************************************************
  * util_queue implementation
  */
@@ -306,7 +330,9 @@ util_queue_thread_func(void *input)
       mtx_unlock(&queue->lock);
 
       if (job.job) {
+         int64_t start = os_time_get_nano();
          job.execute(job.job, job.global_data, thread_index);
+         p_atomic_add(&queue->busy_time_nano, os_time_get_nano() - start);
          if (job.fence)
             util_queue_fence_signal(job.fence);
          if (job.cleanup)
@@ -329,6 +355,8 @@ util_queue_thread_func(void *input)
       queue->num_queued = 0;
    }
    mtx_unlock(&queue->lock);
+
+   p_atomic_dec(&queue_threads_total);
    return 0;
 }
 
@@ -340,7 +368,10 @@ util_queue_create_thread(struct util_queue *queue, unsigned index)
    input->queue = queue;
    input->thread_index = index;
 
+   p_atomic_inc(&queue_threads_total);
+
    if (thrd_success != u_thread_create(queue->threads + index, util_queue_thread_func, input)) {
+      p_atomic_dec(&queue_threads_total);
       free(input);
       return false;
    }
@@ -561,9 +592,11 @@ util_queue_add_job_locked(struct util_queue *queue,
                           util_queue_execute_func execute,
                           util_queue_execute_func cleanup,
                           const size_t job_size,
+                          enum util_queue_job_priority priority,
                           bool locked)
 {
    struct util_queue_job *ptr;
+   unsigned pos;
 
    if (!locked)
       mtx_lock(&queue->lock);
@@ -585,7 +618,8 @@ util_queue_add_job_locked(struct util_queue *queue,
    if (queue->num_queued > 0 &&
        queue->create_threads_on_demand &&
        execute != util_queue_finish_execute &&
-       queue->num_threads < queue->max_threads) {
+       queue->num_threads < queue->max_threads &&
+       util_queue_thread_budget_available()) {
       util_queue_adjust_num_threads(queue, queue->num_threads + 1, true);
    }
 
@@ -624,14 +658,30 @@ util_queue_add_job_locked(struct util_queue *queue,
       }
    }
 
-   ptr = &queue->jobs[queue->write_idx];
-   assert(ptr->job == NULL);
+   assert(queue->jobs[queue->write_idx].job == NULL);
+
+   /* The job goes after all queued jobs of the same or a higher priority.
+    * Move the lower priority ones back by one slot to make room for it.
+    */
+   pos = queue->num_queued;
+   while (pos > 0 &&
+          queue->jobs[(queue->read_idx + pos - 1) % queue->max_jobs].priority <
+          priority)
+      pos--;
+
+   for (unsigned i = queue->num_queued; i > pos; i--) {
+      queue->jobs[(queue->read_idx + i) % queue->max_jobs] =
+         queue->jobs[(queue->read_idx + i - 1) % queue->max_jobs];
+   }
+
+   ptr = &queue->jobs[(queue->read_idx + pos) % queue->max_jobs];
    ptr->job = job;
    ptr->global_data = queue->global_data;
    ptr->fence = fence;
    ptr->execute = execute;
    ptr->cleanup = cleanup;
    ptr->job_size = job_size;
+   ptr->priority = priority;
 
    queue->write_idx = (queue->write_idx + 1) % queue->max_jobs;
    queue->total_jobs_size += ptr->job_size;
@@ -651,7 +701,20 @@ util_queue_add_job(struct util_queue *queue,
                    const size_t job_size)
 {
    util_queue_add_job_locked(queue, job, fence, execute, cleanup, job_size,
-                             false);
+                             UTIL_QUEUE_JOB_PRIORITY_NORMAL, false);
+}
+
+void
+util_queue_add_job_with_priority(struct util_queue *queue,
+                                 void *job,
+                                 struct util_queue_fence *fence,
+                                 util_queue_execute_func execute,
+                                 util_queue_execute_func cleanup,
+                                 const size_t job_size,
+                                 enum util_queue_job_priority priority)
+{
+   util_queue_add_job_locked(queue, job, fence, execute, cleanup, job_size,
+                             priority, false);
 }
 
 /**
@@ -693,6 +756,47 @@ util_queue_drop_job(struct util_queue *queue, struct util_queue_fence *fence)
       util_queue_fence_wait(fence);
 }
 
+/**
+ * Move a queued job to the front of the queue and raise it to the highest
+ * priority. This should be called before waiting for a job that may still
+ * be behind other, less urgent jobs, e.g. speculative compiles queued at
+ * a low priority.
+ *
+ * \return true if the job was found in the queue, false if it has already
+ *         started execution or completed.
+ */
+bool
+util_queue_promote_job(struct util_queue *queue,
+                       struct util_queue_fence *fence)
+{
+   bool promoted = false;
+
+   if (util_queue_fence_is_signalled(fence))
+      return false;
+
+   mtx_lock(&queue->lock);
+   for (unsigned i = 0; i < queue->num_queued; i++) {
+      unsigned index = (queue->read_idx + i) % queue->max_jobs;
+
+      if (queue->jobs[index].job && queue->jobs[index].fence == fence) {
+         struct util_queue_job job = queue->jobs[index];
+
+         for (; i > 0; i--) {
+            queue->jobs[(queue->read_idx + i) % queue->max_jobs] =
+               queue->jobs[(queue->read_idx + i - 1) % queue->max_jobs];
+         }
+
+         job.priority = UTIL_QUEUE_JOB_PRIORITY_HIGH;
+         queue->jobs[queue->read_idx] = job;
+         promoted = true;
+         break;
+      }
+   }
+   mtx_unlock(&queue->lock);
+
+   return promoted;
+}
+
 /**
  * Wait until all previously added jobs have completed.
  */
@@ -725,10 +829,14 @@ util_queue_finish(struct util_queue *queue)
    fences = malloc(queue->num_threads * sizeof(*fences));
    util_barrier_init(&barrier, queue->num_threads);
 
+   /* The barrier jobs must execute after all jobs that are already queued,
+    * so they are added at the lowest priority.
+    */
    for (unsigned i = 0; i < queue->num_threads; ++i) {
       util_queue_fence_init(&fences[i]);
       util_queue_add_job_locked(queue, &barrier, &fences[i],
-                                util_queue_finish_execute, NULL, 0, true);
+                                util_queue_finish_execute, NULL, 0,
+                                UTIL_QUEUE_JOB_PRIORITY_LOW, true);
    }
    queue->create_threads_on_demand = true;
    mtx_unlock(&queue->lock);
@@ -750,3 +858,15 @@ util_queue_get_thread_time_nano(struct util_queue *queue, unsigned thread_index)
 
    return util_thread_get_time_nano(queue->threads[thread_index]);
 }
+
+/**
+ * Return the total time all threads of the queue have spent executing jobs.
+ *
+ * Unlike util_queue_get_thread_time_nano, this only counts the time spent
+ * in the queue's own jobs, and it covers all threads of the queue.
+ */
+int64_t
+util_queue_get_busy_time_nano(struct util_queue *queue)
+{
+   return p_atomic_read(&queue->busy_time_nano);
+}
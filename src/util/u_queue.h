@@ -192,6 +192,15 @@ util_queue_fence_wait_timeout(struct util_queue_fence *fence,
 
 typedef void (*util_queue_execute_func)(void *job, void *gdata, int thread_index);
 
+/* Jobs are executed in order of decreasing priority, and in the order they
+ * were added within the same priority.
+ */
+enum util_queue_job_priority {
+   UTIL_QUEUE_JOB_PRIORITY_LOW,
+   UTIL_QUEUE_JOB_PRIORITY_NORMAL,
+   UTIL_QUEUE_JOB_PRIORITY_HIGH,
+};
+
 struct util_queue_job {
    void *job;
    void *global_data;
@@ -199,6 +208,7 @@ struct util_queue_job {
    struct util_queue_fence *fence;
    util_queue_execute_func execute;
    util_queue_execute_func cleanup;
+   enum util_queue_job_priority priority;
 };
 
 /* Put this into your context. */
@@ -218,6 +228,7 @@ struct util_queue {
    size_t total_jobs_size;  /* memory use of all jobs in the queue */
    struct util_queue_job *jobs;
    void *global_data;
+   int64_t busy_time_nano;  /* time spent executing jobs, on all threads */
 
    /* for cleanup at exit(), protected by exit_mutex */
    struct list_head head;
@@ -238,8 +249,17 @@ void util_queue_add_job(struct util_queue *queue,
                         util_queue_execute_func execute,
                         util_queue_execute_func cleanup,
                         const size_t job_size);
+void util_queue_add_job_with_priority(struct util_queue *queue,
+                                      void *job,
+                                      struct util_queue_fence *fence,
+                                      util_queue_execute_func execute,
+                                      util_queue_execute_func cleanup,
+                                      const size_t job_size,
+                                      enum util_queue_job_priority priority);
 void util_queue_drop_job(struct util_queue *queue,
                          struct util_queue_fence *fence);
+bool util_queue_promote_job(struct util_queue *queue,
+                            struct util_queue_fence *fence);
 
 void util_queue_finish(struct util_queue *queue);
 
@@ -253,6 +273,7 @@ util_queue_adjust_num_threads(struct util_queue *queue, unsigned num_threads,
 
 int64_t util_queue_get_thread_time_nano(struct util_queue *queue,
                                         unsigned thread_index);
+int64_t util_queue_get_busy_time_nano(struct util_queue *queue);
 
 /* util_queue needs to be cleared to zeroes for this to work */
 static inline bool
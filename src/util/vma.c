@@ -29,25 +29,135 @@
 #include "util/vma.h"
 
 struct util_vma_hole {
-   struct list_head link;
+   /** Link in util_vma_heap::holes */
+   struct rb_node node;
+   /** Link in util_vma_heap::holes_by_size */
+   struct rb_node size_node;
    uint64_t offset;
    uint64_t size;
 };
 
+#define util_vma_hole_from_node(_node) \
+   rb_node_data(struct util_vma_hole, _node, node)
+
+#define util_vma_hole_from_size_node(_node) \
+   rb_node_data(struct util_vma_hole, _node, size_node)
+
 #define util_vma_foreach_hole(_hole, _heap) \
-   list_for_each_entry(struct util_vma_hole, _hole, &(_heap)->holes, link)
+   rb_tree_foreach(struct util_vma_hole, _hole, &(_heap)->holes, node)
+
+#define util_vma_foreach_hole_rev(_hole, _heap) \
+   rb_tree_foreach_rev(struct util_vma_hole, _hole, &(_heap)->holes, node)
+
+static int
+util_vma_hole_cmp(const struct rb_node *_a, const struct rb_node *_b)
+{
+   const struct util_vma_hole *a = util_vma_hole_from_node(_a);
+   const struct util_vma_hole *b = util_vma_hole_from_node(_b);
+
+   if (b->offset < a->offset)
+      return -1;
+   return b->offset > a->offset;
+}
 
-#define util_vma_foreach_hole_safe(_hole, _heap) \
-   list_for_each_entry_safe(struct util_vma_hole, _hole, &(_heap)->holes, link)
+static int
+util_vma_hole_size_cmp(const struct rb_node *_a, const struct rb_node *_b)
+{
+   const struct util_vma_hole *a = util_vma_hole_from_size_node(_a);
+   const struct util_vma_hole *b = util_vma_hole_from_size_node(_b);
+
+   if (b->size != a->size)
+      return b->size < a->size ? -1 : 1;
+   if (b->offset < a->offset)
+      return -1;
+   return b->offset > a->offset;
+}
+
+static struct util_vma_hole *
+util_vma_heap_add_hole(struct util_vma_heap *heap,
+                       uint64_t offset, uint64_t size)
+{
+   struct util_vma_hole *hole = calloc(1, sizeof(*hole));
 
-#define util_vma_foreach_hole_safe_rev(_hole, _heap) \
-   list_for_each_entry_safe_rev(struct util_vma_hole, _hole, &(_heap)->holes, link)
+   hole->offset = offset;
+   hole->size = size;
+   rb_tree_insert(&heap->holes, &hole->node, util_vma_hole_cmp);
+   rb_tree_insert(&heap->holes_by_size, &hole->size_node,
+                  util_vma_hole_size_cmp);
+
+   return hole;
+}
+
+static void
+util_vma_heap_remove_hole(struct util_vma_heap *heap,
+                          struct util_vma_hole *hole)
+{
+   rb_tree_remove(&heap->holes, &hole->node);
+   rb_tree_remove(&heap->holes_by_size, &hole->size_node);
+   free(hole);
+}
+
+/* Holes never overlap, so moving the bounds of a hole within the space
+ * between its neighbours doesn't change its position in the address tree.
+ * Only the size tree needs to be updated.
+ */
+static void
+util_vma_hole_resize(struct util_vma_heap *heap, struct util_vma_hole *hole,
+                     uint64_t offset, uint64_t size)
+{
+   rb_tree_remove(&heap->holes_by_size, &hole->size_node);
+   hole->offset = offset;
+   hole->size = size;
+   rb_tree_insert(&heap->holes_by_size, &hole->size_node,
+                  util_vma_hole_size_cmp);
+}
+
+/* Returns the highest hole starting at or below offset */
+static struct util_vma_hole *
+util_vma_heap_find_hole_below(struct util_vma_heap *heap, uint64_t offset)
+{
+   struct util_vma_hole *found = NULL;
+   struct rb_node *n = heap->holes.root;
+
+   while (n != NULL) {
+      struct util_vma_hole *hole = util_vma_hole_from_node(n);
+      if (hole->offset <= offset) {
+         found = hole;
+         n = n->right;
+      } else {
+         n = n->left;
+      }
+   }
+
+   return found;
+}
+
+/* Returns the smallest (and then lowest) hole with at least size bytes */
+static struct util_vma_hole *
+util_vma_heap_find_hole_fit(struct util_vma_heap *heap, uint64_t size)
+{
+   struct util_vma_hole *found = NULL;
+   struct rb_node *n = heap->holes_by_size.root;
+
+   while (n != NULL) {
+      struct util_vma_hole *hole = util_vma_hole_from_size_node(n);
+      if (hole->size >= size) {
+         found = hole;
+         n = n->left;
+      } else {
+         n = n->right;
+      }
+   }
+
+   return found;
+}
 
 void
 util_vma_heap_init(struct util_vma_heap *heap,
                    uint64_t start, uint64_t size)
 {
-   list_inithead(&heap->holes);
+   rb_tree_init(&heap->holes);
+   rb_tree_init(&heap->holes_by_size);
    heap->free_size = 0;
    util_vma_heap_free(heap, start, size);
 
@@ -56,13 +166,29 @@ util_vma_heap_init(struct util_vma_heap *heap,
 
    /* Default to not having a nospan alignment */
    heap->nospan_shift = 0;
+
+   /* Default to first-fit in address order */
+   heap->best_fit = false;
+}
+
+/* rb_node_next() walks through parents so holes can't be freed while
+ * iterating in order.  Free children before their parent instead.
+ */
+static void
+util_vma_free_holes(struct rb_node *n)
+{
+   if (n == NULL)
+      return;
+
+   util_vma_free_holes(n->left);
+   util_vma_free_holes(n->right);
+   free(util_vma_hole_from_node(n));
 }
 
 void
 util_vma_heap_finish(struct util_vma_heap *heap)
 {
-   util_vma_foreach_hole_safe(hole, heap)
-      free(hole);
+   util_vma_free_holes(heap->holes.root);
 }
 
 #ifndef NDEBUG
@@ -70,31 +196,44 @@ static void
 util_vma_heap_validate(struct util_vma_heap *heap)
 {
    uint64_t free_size = 0;
-   uint64_t prev_offset = 0;
+   unsigned num_holes = 0;
+   struct util_vma_hole *prev = NULL;
    util_vma_foreach_hole(hole, heap) {
       assert(hole->offset > 0);
       assert(hole->size > 0);
 
       free_size += hole->size;
+      num_holes++;
 
-      if (&hole->link == heap->holes.next) {
-         /* This must be the top-most hole.  Assert that, if it overflows, it
-          * overflows to 0, i.e. 2^64.
-          */
-         assert(hole->size + hole->offset == 0 ||
-                hole->size + hole->offset > hole->offset);
-      } else {
-         /* This is not the top-most hole so it must not overflow and, in
-          * fact, must be strictly lower than the top-most hole.  If
-          * hole->size + hole->offset == prev_offset, then we failed to join
+      if (prev) {
+         /* The previous hole is not the top-most hole so it must not
+          * overflow and, in fact, must end strictly below this hole.  If
+          * prev->size + prev->offset == hole->offset, then we failed to join
           * holes during a util_vma_heap_free.
           */
-         assert(hole->size + hole->offset > hole->offset &&
-                hole->size + hole->offset < prev_offset);
+         assert(prev->size + prev->offset > prev->offset &&
+                prev->size + prev->offset < hole->offset);
       }
-      prev_offset = hole->offset;
+      prev = hole;
    }
 
+   if (prev) {
+      /* This must be the top-most hole.  Assert that, if it overflows, it
+       * overflows to 0, i.e. 2^64.
+       */
+      assert(prev->size + prev->offset == 0 ||
+             prev->size + prev->offset > prev->offset);
+   }
+
+   prev = NULL;
+   rb_tree_foreach(struct util_vma_hole, hole, &heap->holes_by_size, size_node) {
+      assert(prev == NULL || prev->size < hole->size ||
+             (prev->size == hole->size && prev->offset < hole->offset));
+      prev = hole;
+      num_holes--;
+   }
+   assert(num_holes == 0);
+
    assert(free_size == heap->free_size);
 }
 #else
@@ -111,8 +250,7 @@ util_vma_hole_alloc(struct util_vma_heap *heap,
 
    if (offset == hole->offset && size == hole->size) {
       /* Just get rid of the hole. */
-      list_del(&hole->link);
-      free(hole);
+      util_vma_heap_remove_hole(heap, hole);
       goto done;
    }
 
@@ -120,38 +258,102 @@ util_vma_hole_alloc(struct util_vma_heap *heap,
    uint64_t waste = (hole->size - size) - (offset - hole->offset);
    if (waste == 0) {
       /* We allocated at the top.  Shrink the hole down. */
-      hole->size -= size;
+      util_vma_hole_resize(heap, hole, hole->offset, hole->size - size);
       goto done;
    }
 
    if (offset == hole->offset) {
       /* We allocated at the bottom. Shrink the hole up. */
-      hole->offset += size;
-      hole->size -= size;
+      util_vma_hole_resize(heap, hole, hole->offset + size, hole->size - size);
       goto done;
    }
 
    /* We allocated in the middle.  We need to split the old hole into two
     * holes, one high and one low.
     */
-   struct util_vma_hole *high_hole = calloc(1, sizeof(*hole));
-   high_hole->offset = offset + size;
-   high_hole->size = waste;
+   util_vma_heap_add_hole(heap, offset + size, waste);
 
    /* Adjust the hole to be the amount of space left at he bottom of the
     * original hole.
     */
-   hole->size = offset - hole->offset;
-
-   /* Place the new hole before the old hole so that the list is in order
-    * from high to low.
-    */
-   list_addtail(&high_hole->link, &hole->link);
+   util_vma_hole_resize(heap, hole, hole->offset, offset - hole->offset);
 
  done:
    heap->free_size -= size;
 }
 
+/* Computes where an allocation would land in the given hole, honoring
+ * alloc_high, the alignment and nospan_shift.  Returns false if it doesn't
+ * fit.
+ */
+static bool
+util_vma_hole_place(struct util_vma_heap *heap,
+                    const struct util_vma_hole *hole,
+                    uint64_t size, uint64_t alignment,
+                    uint64_t *offset_out)
+{
+   if (size > hole->size)
+      return false;
+
+   if (heap->alloc_high) {
+      /* Compute the offset as the highest address where a chunk of the
+       * given size can be without going over the top of the hole.
+       *
+       * This calculation is known to not overflow because we know that
+       * hole->size + hole->offset can only overflow to 0 and size > 0.
+       */
+      uint64_t offset = (hole->size - size) + hole->offset;
+
+      if (heap->nospan_shift) {
+         uint64_t end = offset + size - 1;
+         if ((end >> heap->nospan_shift) != (offset >> heap->nospan_shift)) {
+            /* can we shift the offset down and still fit in the current hole? */
+            end &= ~BITFIELD64_MASK(heap->nospan_shift);
+            assert(end >= size);
+            offset -= size;
+            if (offset < hole->offset)
+               return false;
+         }
+      }
+
+      /* Align the offset.  We align down and not up because we are
+       * allocating from the top of the hole and not the bottom.
+       */
+      offset = (offset / alignment) * alignment;
+
+      if (offset < hole->offset)
+         return false;
+
+      *offset_out = offset;
+   } else {
+      uint64_t offset = hole->offset;
+
+      /* Align the offset */
+      uint64_t misalign = offset % alignment;
+      if (misalign) {
+         uint64_t pad = alignment - misalign;
+         if (pad > hole->size - size)
+            return false;
+
+         offset += pad;
+      }
+
+      if (heap->nospan_shift) {
+         uint64_t end = offset + size - 1;
+         if ((end >> heap->nospan_shift) != (offset >> heap->nospan_shift)) {
+            /* can we shift the offset up and still fit in the current hole? */
+            offset = end & ~BITFIELD64_MASK(heap->nospan_shift);
+            if ((offset + size) > (hole->offset + hole->size))
+               return false;
+         }
+      }
+
+      *offset_out = offset;
+   }
+
+   return true;
+}
+
 uint64_t
 util_vma_heap_alloc(struct util_vma_heap *heap,
                     uint64_t size, uint64_t alignment)
@@ -170,73 +372,38 @@ util_vma_heap_alloc(struct util_vma_heap *heap,
             BITFIELD64_BIT(heap->nospan_shift));
    }
 
-   if (heap->alloc_high) {
-      util_vma_foreach_hole_safe(hole, heap) {
-         if (size > hole->size)
-            continue;
-
-         /* Compute the offset as the highest address where a chunk of the
-          * given size can be without going over the top of the hole.
-          *
-          * This calculation is known to not overflow because we know that
-          * hole->size + hole->offset can only overflow to 0 and size > 0.
-          */
-         uint64_t offset = (hole->size - size) + hole->offset;
-
-         if (heap->nospan_shift) {
-            uint64_t end = offset + size - 1;
-            if ((end >> heap->nospan_shift) != (offset >> heap->nospan_shift)) {
-               /* can we shift the offset down and still fit in the current hole? */
-               end &= ~BITFIELD64_MASK(heap->nospan_shift);
-               assert(end >= size);
-               offset -= size;
-               if (offset < hole->offset)
-                  continue;
-            }
+   uint64_t offset;
+   if (heap->best_fit) {
+      /* Holes in the size tree are visited from the smallest one which is
+       * big enough.  We only move on to bigger holes when alignment or
+       * nospan_shift padding doesn't fit, which is rare.
+       */
+      for (struct util_vma_hole *hole = util_vma_heap_find_hole_fit(heap, size);
+           hole != NULL;) {
+         if (util_vma_hole_place(heap, hole, size, alignment, &offset)) {
+            util_vma_hole_alloc(heap, hole, offset, size);
+            util_vma_heap_validate(heap);
+            return offset;
          }
 
-         /* Align the offset.  We align down and not up because we are
-          * allocating from the top of the hole and not the bottom.
-          */
-         offset = (offset / alignment) * alignment;
-
-         if (offset < hole->offset)
-            continue;
-
-         util_vma_hole_alloc(heap, hole, offset, size);
-         util_vma_heap_validate(heap);
-         return offset;
+         struct rb_node *next = rb_node_next(&hole->size_node);
+         hole = next ? util_vma_hole_from_size_node(next) : NULL;
       }
-   } else {
-      util_vma_foreach_hole_safe_rev(hole, heap) {
-         if (size > hole->size)
-            continue;
-
-         uint64_t offset = hole->offset;
-
-         /* Align the offset */
-         uint64_t misalign = offset % alignment;
-         if (misalign) {
-            uint64_t pad = alignment - misalign;
-            if (pad > hole->size - size)
-               continue;
-
-            offset += pad;
+   } else if (heap->alloc_high) {
+      util_vma_foreach_hole_rev(hole, heap) {
+         if (util_vma_hole_place(heap, hole, size, alignment, &offset)) {
+            util_vma_hole_alloc(heap, hole, offset, size);
+            util_vma_heap_validate(heap);
+            return offset;
          }
-
-         if (heap->nospan_shift) {
-            uint64_t end = offset + size - 1;
-            if ((end >> heap->nospan_shift) != (offset >> heap->nospan_shift)) {
-               /* can we shift the offset up and still fit in the current hole? */
-               offset = end & ~BITFIELD64_MASK(heap->nospan_shift);
-               if ((offset + size) > (hole->offset + hole->size))
-                  continue;
-            }
+      }
+   } else {
+      util_vma_foreach_hole(hole, heap) {
+         if (util_vma_hole_place(heap, hole, size, alignment, &offset)) {
+            util_vma_hole_alloc(heap, hole, offset, size);
+            util_vma_heap_validate(heap);
+            return offset;
          }
-
-         util_vma_hole_alloc(heap, hole, offset, size);
-         util_vma_heap_validate(heap);
-         return offset;
       }
    }
 
@@ -261,25 +428,16 @@ util_vma_heap_alloc_addr(struct util_vma_heap *heap,
     */
    assert(offset + size == 0 || offset + size > offset);
 
-   /* Find the hole if one exists. */
-   util_vma_foreach_hole_safe(hole, heap) {
-      if (hole->offset > offset)
-         continue;
-
-      /* Holes are ordered high-to-low so the first hole we find with
-       * hole->offset <= is our hole.  If it's not big enough to contain the
-       * requested range, then the allocation fails.
-       */
-      assert(hole->offset <= offset);
-      if (hole->size < offset - hole->offset + size)
-         return false;
-
-      util_vma_hole_alloc(heap, hole, offset, size);
-      return true;
-   }
+   /* The only hole which can contain the range is the highest one starting
+    * at or below offset.  If it's not big enough to contain the requested
+    * range, then the allocation fails.
+    */
+   struct util_vma_hole *hole = util_vma_heap_find_hole_below(heap, offset);
+   if (hole == NULL || hole->size < offset - hole->offset + size)
+      return false;
 
-   /* We didn't find a suitable hole */
-   return false;
+   util_vma_hole_alloc(heap, hole, offset, size);
+   return true;
 }
 
 void
@@ -302,14 +460,12 @@ util_vma_heap_free(struct util_vma_heap *heap,
    util_vma_heap_validate(heap);
 
    /* Find immediately higher and lower holes if they exist. */
-   struct util_vma_hole *high_hole = NULL, *low_hole = NULL;
-   util_vma_foreach_hole(hole, heap) {
-      if (hole->offset <= offset) {
-         low_hole = hole;
-         break;
-      }
-      high_hole = hole;
-   }
+   struct util_vma_hole *low_hole =
+      util_vma_heap_find_hole_below(heap, offset);
+   struct rb_node *high_node = low_hole ? rb_node_next(&low_hole->node) :
+                                          rb_tree_first(&heap->holes);
+   struct util_vma_hole *high_hole =
+      high_node ? util_vma_hole_from_node(high_node) : NULL;
 
    if (high_hole)
       assert(offset + size <= high_hole->offset);
@@ -323,28 +479,19 @@ util_vma_heap_free(struct util_vma_heap *heap,
 
    if (low_adjacent && high_adjacent) {
       /* Merge the two holes */
-      low_hole->size += size + high_hole->size;
-      list_del(&high_hole->link);
-      free(high_hole);
+      uint64_t merged_size = low_hole->size + size + high_hole->size;
+      util_vma_heap_remove_hole(heap, high_hole);
+      util_vma_hole_resize(heap, low_hole, low_hole->offset, merged_size);
    } else if (low_adjacent) {
       /* Merge into the low hole */
-      low_hole->size += size;
+      util_vma_hole_resize(heap, low_hole, low_hole->offset,
+                           low_hole->size + size);
    } else if (high_adjacent) {
       /* Merge into the high hole */
-      high_hole->offset = offset;
-      high_hole->size += size;
+      util_vma_hole_resize(heap, high_hole, offset, high_hole->size + size);
    } else {
       /* Neither hole is adjacent; make a new one */
-      struct util_vma_hole *hole = calloc(1, sizeof(*hole));
-
-      hole->offset = offset;
-      hole->size = size;
-
-      /* Add it after the high hole so we maintain high-to-low ordering */
-      if (high_hole)
-         list_add(&hole->link, &high_hole->link);
-      else
-         list_add(&hole->link, &heap->holes);
+      util_vma_heap_add_hole(heap, offset, size);
    }
 
    heap->free_size += size;
@@ -358,7 +505,7 @@ util_vma_heap_print(struct util_vma_heap *heap, FILE *fp,
    fprintf(fp, "%sutil_vma_heap:\n", tab);
 
    uint64_t total_free = 0;
-   util_vma_foreach_hole(hole, heap) {
+   util_vma_foreach_hole_rev(hole, heap) {
       fprintf(fp, "%s    hole: offset = %"PRIu64" (0x%"PRIx64"), "
               "size = %"PRIu64" (0x%"PRIx64")\n",
               tab, hole->offset, hole->offset, hole->size, hole->size);
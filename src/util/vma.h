@@ -28,13 +28,18 @@
 #include <stdio.h>
 
 #include "list.h"
+#include "rb_tree.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct util_vma_heap {
-   struct list_head holes;
+   /** Holes ordered by address */
+   struct rb_tree holes;
+
+   /** Holes ordered by size, then by address */
+   struct rb_tree holes_by_size;
 
    /** Total size of free memory. */
    uint64_t free_size;
@@ -51,6 +56,17 @@ struct util_vma_heap {
     * which straddle 4GB boundaries, use nospan_shift=log2(4GB)
     */
    unsigned nospan_shift;
+
+   /** If true, util_vma_heap_alloc will pick the smallest hole which can
+    * satisfy the allocation instead of the first one in address order.
+    * alloc_high still decides which end of that hole is used.
+    *
+    * This keeps allocation O(log(holes)) on fragmented heaps and tends to
+    * keep large holes intact, at the cost of less predictable addresses.
+    *
+    * Default is false.
+    */
+   bool best_fit;
 };
 
 void util_vma_heap_init(struct util_vma_heap *heap,